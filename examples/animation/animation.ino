@@ -0,0 +1,32 @@
+/**************************************************************************
+ This is an example for Monochrome LCD based on ST7558 drivers
+ using I2C to communicate.
+ 3 pins are required to interface (two I2C and one reset).
+
+ A looping splash animation played from flash. spinner.h was made from
+ 16 PBM images with extras/host/encoder: 877 bytes instead of 13824 for
+ the raw frames. Each frame is decoded straight into the framebuffer and
+ display() sends only the columns it changed.
+ **************************************************************************/
+
+#include <Adafruit_GFX.h>
+#include <ST7558.h>
+#include <ST7558Animation.h>
+#include "spinner.h"
+
+#define RESET_PIN     A3
+ST7558 display(RESET_PIN);
+ST7558Animation animation(display);
+
+void setup() {
+
+    display.begin();
+    animation.begin(spinner, sizeof(spinner));
+}
+
+void loop() {
+
+    if (animation.update()) {
+        display.display();
+    }
+}
@@ -0,0 +1,77 @@
+// spinner: 16 frames of 96x65, 80 ms each, made by extras/host/encoder
+const uint8_t spinner[] PROGMEM = {
+    0xB7, 0x01, 0x60, 0x41, 0xFD, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x3F,
+    0x3F, 0x04, 0x82, 0x80, 0xC0, 0x80, 0x04, 0x86, 0x10, 0x7C, 0x7C, 0xFE,
+    0x7C, 0x7C, 0x10, 0x05, 0x80, 0x80, 0x3F, 0x08, 0x84, 0x01, 0x03, 0x07,
+    0x03, 0x01, 0x0F, 0x82, 0x01, 0x03, 0x01, 0x3F, 0x03, 0x84, 0x04, 0x0E,
+    0x1F, 0x0E, 0x04, 0x17, 0x82, 0x04, 0x0E, 0x04, 0x3F, 0x04, 0x82, 0x10,
+    0x38, 0x10, 0x07, 0x80, 0x80, 0x07, 0x82, 0x10, 0x38, 0x10, 0x3F, 0x12,
+    0x82, 0x01, 0x03, 0x01, 0x3D, 0x81, 0xFC, 0x04, 0x42, 0xF4, 0x79, 0x04,
+    0x80, 0xFC, 0x1F, 0x80, 0x03, 0x7D, 0x02, 0x80, 0x03, 0xFF, 0xFE, 0x01,
+    0x00, 0x50, 0x00, 0x00, 0x00, 0x3F, 0x3F, 0x0C, 0x86, 0x10, 0x6C, 0x44,
+    0x82, 0x44, 0x6C, 0x10, 0x03, 0x84, 0xC0, 0xC0, 0x60, 0xC0, 0xC0, 0x3F,
+    0x19, 0x86, 0x01, 0x07, 0x06, 0x0C, 0x06, 0x07, 0x01, 0x3F, 0x01, 0x84,
+    0x04, 0x0A, 0x11, 0x0A, 0x04, 0x3F, 0x3F, 0x3F, 0x3F, 0x0F, 0x43, 0xF0,
+    0xFF, 0xFE, 0x02, 0x00, 0xA0, 0x00, 0x00, 0x00, 0x3F, 0x3F, 0x04, 0x82,
+    0x80, 0x40, 0x80, 0x0F, 0x84, 0xC0, 0x40, 0x20, 0x40, 0xC0, 0x3F, 0x06,
+    0x84, 0x01, 0x02, 0x04, 0x02, 0x01, 0x0D, 0x87, 0x01, 0x06, 0x04, 0x08,
+    0x04, 0x06, 0x01, 0x80, 0x3F, 0x1B, 0x86, 0x04, 0x1F, 0x1B, 0x31, 0x1B,
+    0x1F, 0x04, 0x3F, 0x3F, 0x3F, 0x36, 0x43, 0xF0, 0xFF, 0xFE, 0x03, 0x00,
+    0xF0, 0x00, 0x00, 0x00, 0x3F, 0x3F, 0x0D, 0x84, 0x10, 0x28, 0x44, 0x28,
+    0x10, 0x3F, 0x2A, 0x80, 0x80, 0x3F, 0x1B, 0x86, 0x04, 0x1B, 0x11, 0x20,
+    0x11, 0x1B, 0x04, 0x3F, 0x14, 0x86, 0x10, 0x7C, 0x6C, 0xC6, 0x6C, 0x7C,
+    0x10, 0x3F, 0x3F, 0x1E, 0x43, 0xF0, 0xFF, 0xFE, 0x04, 0x00, 0x40, 0x01,
+    0x00, 0x00, 0x3F, 0x3F, 0x18, 0x82, 0x80, 0x40, 0x80, 0x3F, 0x1B, 0x84,
+    0x01, 0x02, 0x04, 0x02, 0x01, 0x3F, 0x3F, 0x30, 0x84, 0xC0, 0xC0, 0x60,
+    0xC0, 0xC0, 0x03, 0x86, 0x10, 0x6C, 0x44, 0x82, 0x44, 0x6C, 0x10, 0x3F,
+    0x0E, 0x86, 0x01, 0x07, 0x06, 0x0C, 0x06, 0x07, 0x01, 0x3F, 0x0C, 0x42,
+    0xF0, 0xFF, 0xFE, 0x05, 0x00, 0x90, 0x01, 0x00, 0x00, 0x3F, 0x3F, 0x3F,
+    0x3F, 0x3F, 0x1B, 0x84, 0x04, 0x0A, 0x11, 0x0A, 0x04, 0x3F, 0x01, 0x86,
+    0x10, 0x7C, 0x6C, 0xC6, 0x6C, 0x7C, 0x10, 0x03, 0x84, 0xC0, 0x40, 0x20,
+    0x40, 0xC0, 0x3F, 0x19, 0x86, 0x01, 0x06, 0x04, 0x08, 0x04, 0x06, 0x01,
+    0x3F, 0x0F, 0x43, 0xF0, 0xFF, 0xFE, 0x06, 0x00, 0xE0, 0x01, 0x00, 0x00,
+    0x3F, 0x3F, 0x3F, 0x21, 0x80, 0x80, 0x3F, 0x1B, 0x86, 0x04, 0x1F, 0x1B,
+    0x31, 0x1B, 0x1F, 0x04, 0x3F, 0x1C, 0x86, 0x10, 0x6C, 0x44, 0x82, 0x44,
+    0x6C, 0x10, 0x0D, 0x84, 0x10, 0x28, 0x44, 0x28, 0x10, 0x3F, 0x3F, 0x2A,
+    0x43, 0xF0, 0xFF, 0xFE, 0x07, 0x00, 0x30, 0x02, 0x00, 0x00, 0x3F, 0x3F,
+    0x03, 0x84, 0xC0, 0xC0, 0x60, 0xC0, 0xC0, 0x3F, 0x18, 0x87, 0x80, 0x01,
+    0x07, 0x06, 0x0C, 0x06, 0x07, 0x01, 0x3F, 0x14, 0x86, 0x04, 0x1B, 0x11,
+    0x20, 0x11, 0x1B, 0x04, 0x3F, 0x28, 0x82, 0x80, 0x40, 0x80, 0x3F, 0x1B,
+    0x84, 0x01, 0x02, 0x04, 0x02, 0x01, 0x3F, 0x18, 0x43, 0xF0, 0xFF, 0xFE,
+    0x08, 0x00, 0x80, 0x02, 0x00, 0x00, 0x3F, 0x3F, 0x03, 0x84, 0xC0, 0x40,
+    0x20, 0x40, 0xC0, 0x03, 0x86, 0x10, 0x7C, 0x6C, 0xC6, 0x6C, 0x7C, 0x10,
+    0x3F, 0x0E, 0x86, 0x01, 0x06, 0x04, 0x08, 0x04, 0x06, 0x01, 0x3F, 0x3F,
+    0x39, 0x84, 0x10, 0x28, 0x44, 0x28, 0x10, 0x3F, 0x3F, 0x3F, 0x06, 0x42,
+    0xF0, 0xFF, 0xFE, 0x09, 0x00, 0xD0, 0x02, 0x00, 0x00, 0x3F, 0x3F, 0x0C,
+    0x86, 0x10, 0x6C, 0x44, 0x82, 0x44, 0x6C, 0x10, 0x03, 0x84, 0xC0, 0xC0,
+    0x60, 0xC0, 0xC0, 0x3F, 0x19, 0x86, 0x01, 0x07, 0x06, 0x0C, 0x06, 0x07,
+    0x01, 0x3F, 0x01, 0x84, 0x04, 0x0A, 0x11, 0x0A, 0x04, 0x3F, 0x3F, 0x3F,
+    0x3F, 0x2D, 0x43, 0xF0, 0xFF, 0xFE, 0x0A, 0x00, 0x20, 0x03, 0x00, 0x00,
+    0x3F, 0x3F, 0x04, 0x82, 0x80, 0x40, 0x80, 0x0F, 0x84, 0xC0, 0x40, 0x20,
+    0x40, 0xC0, 0x3F, 0x06, 0x84, 0x01, 0x02, 0x04, 0x02, 0x01, 0x0D, 0x87,
+    0x01, 0x06, 0x04, 0x08, 0x04, 0x06, 0x01, 0x80, 0x3F, 0x1B, 0x86, 0x04,
+    0x1F, 0x1B, 0x31, 0x1B, 0x1F, 0x04, 0x3F, 0x3F, 0x3F, 0x3F, 0x14, 0x43,
+    0xF0, 0xFF, 0xFE, 0x0B, 0x00, 0x70, 0x03, 0x00, 0x00, 0x3F, 0x3F, 0x0D,
+    0x84, 0x10, 0x28, 0x44, 0x28, 0x10, 0x3F, 0x2A, 0x80, 0x80, 0x3F, 0x1B,
+    0x86, 0x04, 0x1B, 0x11, 0x20, 0x11, 0x1B, 0x04, 0x3F, 0x14, 0x86, 0x10,
+    0x7C, 0x6C, 0xC6, 0x6C, 0x7C, 0x10, 0x3F, 0x3F, 0x3C, 0x43, 0xF0, 0xFF,
+    0xFE, 0x0C, 0x00, 0xC0, 0x03, 0x00, 0x00, 0x3F, 0x3F, 0x18, 0x82, 0x80,
+    0x40, 0x80, 0x3F, 0x1B, 0x84, 0x01, 0x02, 0x04, 0x02, 0x01, 0x3F, 0x3F,
+    0x30, 0x84, 0xC0, 0xC0, 0x60, 0xC0, 0xC0, 0x03, 0x86, 0x10, 0x6C, 0x44,
+    0x82, 0x44, 0x6C, 0x10, 0x3F, 0x0E, 0x86, 0x01, 0x07, 0x06, 0x0C, 0x06,
+    0x07, 0x01, 0x3F, 0x2A, 0x42, 0xF0, 0xFF, 0xFE, 0x0D, 0x00, 0x10, 0x04,
+    0x00, 0x00, 0x3F, 0x3F, 0x3F, 0x3F, 0x3F, 0x1B, 0x84, 0x04, 0x0A, 0x11,
+    0x0A, 0x04, 0x3F, 0x01, 0x86, 0x10, 0x7C, 0x6C, 0xC6, 0x6C, 0x7C, 0x10,
+    0x03, 0x84, 0xC0, 0x40, 0x20, 0x40, 0xC0, 0x3F, 0x19, 0x86, 0x01, 0x06,
+    0x04, 0x08, 0x04, 0x06, 0x01, 0x3F, 0x2D, 0x43, 0xF0, 0xFF, 0xFE, 0x0E,
+    0x00, 0x60, 0x04, 0x00, 0x00, 0x3F, 0x3F, 0x3F, 0x21, 0x80, 0x80, 0x3F,
+    0x1B, 0x86, 0x04, 0x1F, 0x1B, 0x31, 0x1B, 0x1F, 0x04, 0x3F, 0x1C, 0x86,
+    0x10, 0x6C, 0x44, 0x82, 0x44, 0x6C, 0x10, 0x0D, 0x84, 0x10, 0x28, 0x44,
+    0x28, 0x10, 0x3F, 0x3F, 0x3F, 0x08, 0x43, 0xF0, 0xFF, 0xFE, 0x0F, 0x00,
+    0xB0, 0x04, 0x00, 0x00, 0x3F, 0x3F, 0x03, 0x84, 0xC0, 0xC0, 0x60, 0xC0,
+    0xC0, 0x3F, 0x18, 0x87, 0x80, 0x01, 0x07, 0x06, 0x0C, 0x06, 0x07, 0x01,
+    0x3F, 0x14, 0x86, 0x04, 0x1B, 0x11, 0x20, 0x11, 0x1B, 0x04, 0x3F, 0x28,
+    0x82, 0x80, 0x40, 0x80, 0x3F, 0x1B, 0x84, 0x01, 0x02, 0x04, 0x02, 0x01,
+    0x3F, 0x36, 0x43, 0xF0, 0xFF, 0xFE, 0x10, 0x00, 0x00, 0x05, 0x00, 0x00,
+    0xFF
+};
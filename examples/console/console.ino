@@ -0,0 +1,45 @@
+/**************************************************************************
+ This is an example for Monochrome LCD based on ST7558 drivers
+ using I2C to communicate.
+ 3 pins are required to interface (two I2C and one reset).
+
+ A diagnostic console logging an analog input. Only the characters that
+ change are redrawn, and a new line shifts the lines above it instead of
+ repainting them. Pull pin 2 low to look at the lines scrolled off.
+ **************************************************************************/
+
+#include <Adafruit_GFX.h>
+#include <ST7558.h>
+#include <ST7558Console.h>
+
+#define RESET_PIN     A3
+#define BACK_PIN      2
+ST7558 display(RESET_PIN);
+ST7558Console console(display);
+
+void setup() {
+
+    pinMode(BACK_PIN, INPUT_PULLUP);
+    display.begin();
+    display.clearDisplay();
+
+    console.setAttributes(ST7558_CONSOLE_INVERSE);
+    console.print(F("boot ok"));
+    console.setAttributes(0);
+    console.showCursor(true);
+}
+
+void loop() {
+
+    if (digitalRead(BACK_PIN) == LOW) {
+        console.scrollBack(ST7558_CONSOLE_SCROLLBACK);
+    } else {
+        console.print(F("\n"));
+        console.print(millis() / 1000);
+        console.print(F("s A0="));
+        console.print(analogRead(A0));
+    }
+    console.render();
+    display.display();
+    delay(250);
+}
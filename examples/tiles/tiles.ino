@@ -0,0 +1,78 @@
+/**************************************************************************
+ This is an example for Monochrome LCD based on ST7558 drivers
+ using I2C to communicate.
+ 3 pins are required to interface (two I2C and one reset).
+
+ A brick room on the tile layer with two balls bouncing around in it.
+ Each frame only the tiles the balls leave and enter are redrawn, so a
+ frame is a few dozen bytes on the bus instead of the whole screen.
+ **************************************************************************/
+
+#include <Adafruit_GFX.h>
+#include <ST7558.h>
+#include <ST7558Tiles.h>
+
+#define RESET_PIN     A3
+ST7558 display(RESET_PIN);
+ST7558TileLayer layer(display);
+
+#define FLOOR   0
+#define BRICK   1
+#define PILLAR  2
+
+// 8x8 tiles, one byte per column, LSB on top
+static const uint8_t PROGMEM tileset[] = {
+    0x00, 0x00, 0x00, 0x10, 0x00, 0x00, 0x00, 0x01,     // floor
+    0xFF, 0x11, 0x11, 0x11, 0xFF, 0x88, 0x88, 0x88,     // brick
+    0x00, 0x7E, 0x42, 0x5A, 0x5A, 0x42, 0x7E, 0x00      // pillar
+};
+
+// 8x8 ball and its mask, so the floor shows around it
+static const uint8_t PROGMEM ball[] = { 0x3C, 0x42, 0x81, 0x85, 0x8D, 0x9A, 0x42, 0x3C };
+static const uint8_t PROGMEM ballMask[] = { 0x3C, 0x7E, 0xFF, 0xFF, 0xFF, 0xFF, 0x7E, 0x3C };
+
+struct Ball {
+    int16_t x, y;
+    int8_t dx, dy;
+} balls[2] = { { 20, 12, 1, 1 }, { 60, 40, -1, 1 } };
+
+void setup() {
+
+    display.begin();
+    display.clearDisplay();
+
+    layer.setTileset(tileset);
+    for (uint8_t ty = 0; ty < ST7558_TILES_Y; ty++) {
+        for (uint8_t tx = 0; tx < ST7558_TILES_X; tx++) {
+
+            const bool wall = tx == 0 || ty == 0 ||
+                              tx == ST7558_TILES_X - 1 || ty == ST7558_TILES_Y - 1;
+            layer.setTile(tx, ty, wall ? BRICK : FLOOR);
+        }
+    }
+    layer.setTile(5, 3, PILLAR);
+    layer.setTile(6, 4, PILLAR);
+    for (uint8_t i = 0; i < 2; i++) {
+        layer.setSprite(i, balls[i].x, balls[i].y, ball, 8, 8, ballMask);
+    }
+}
+
+void loop() {
+
+    for (uint8_t i = 0; i < 2; i++) {
+
+        Ball &b = balls[i];
+        if (b.x + b.dx < 8 || b.x + b.dx > (ST7558_TILES_X - 2) * 8) {
+            b.dx = -b.dx;
+        }
+        if (b.y + b.dy < 8 || b.y + b.dy > (ST7558_TILES_Y - 2) * 8) {
+            b.dy = -b.dy;
+        }
+        b.x += b.dx;
+        b.y += b.dy;
+        layer.moveSprite(i, b.x, b.y);
+    }
+    layer.render();
+    display.display();
+    delay(20);
+}
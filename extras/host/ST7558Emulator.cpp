@@ -0,0 +1,316 @@
+/**
+ * @file ST7558Emulator.cpp
+ *
+ * ST7558 controller model. Only what the driver can observe on the glass
+ * is modeled: addressing, display data RAM, display modes and mirroring.
+ * Analog settings (VOP, bias, booster, PRS) are stored but have no effect
+ * on the picture.
+ */
+
+#include "ST7558Emulator.h"
+#include <stdio.h>
+
+ST7558Emulator::ST7558Emulator(uint8_t width, uint8_t height, uint8_t columnOffset) :
+    _width(width), _height(height), _columnOffset(columnOffset) {
+
+    reset();
+}
+
+/**************************************************************/
+/** @brief Power-on state: chip in power down, basic instruction
+           set, horizontal addressing, display blank, no mirroring.
+           The RAM content is undefined after power-on, so it is
+           filled with noise: frames that rely on it show up
+*/
+/**************************************************************/
+void ST7558Emulator::reset(void) {
+
+    uint32_t noise = 0x2545F491;
+    for (uint8_t page = 0; page < ST7558_RAM_PAGES; page++) {
+        for (uint8_t column = 0; column < ST7558_RAM_WIDTH; column++) {
+
+            noise ^= noise << 13;
+            noise ^= noise >> 17;
+            noise ^= noise << 5;
+            _ram[page][column] = noise;
+        }
+    }
+    _x = _y = 0;
+    _powerDown = true;
+    _vertical = _extended = false;
+    _mirrorX = _mirrorY = false;
+    _displayMode = OFF;
+    _vop = _bias = _boost = _prs = 0;
+    _open = _addressed = false;
+    _control = true;
+    _continue = _data = false;
+    _transactions = _dataBytes = _commands = _errors = 0;
+}
+
+/**************************************************************/
+/** @brief START and slave address. Transactions to other
+           addresses are ignored
+*/
+/**************************************************************/
+void ST7558Emulator::beginTransmission(const uint8_t address) {
+
+    _open = true;
+    _addressed = address == ST7558_I2C_ADDRESS;
+    _control = true;
+    if (_addressed) {
+        _transactions++;
+    }
+}
+
+/**************************************************************/
+/** @brief One byte after the address: a control byte (Co, D/C),
+           or a command or data byte as the last control byte says
+*/
+/**************************************************************/
+void ST7558Emulator::write(const uint8_t data) {
+
+    if (!_open || !_addressed) {
+        return;
+    }
+    if (_control) {
+
+        if (data & 0x3F) {
+            _errors++;                      // the low six bits must be zero
+        }
+        _continue = data & ST7558_CONTINUE;
+        _data = data & ST7558_DATA;
+        _control = false;
+        return;
+    }
+    if (_data) {
+        _writeData(data);
+    } else {
+        _command(data);
+    }
+    _control = _continue;                   // Co = 1: a control byte follows each byte
+}
+
+/**************************************************************/
+/** @brief STOP
+*/
+/**************************************************************/
+void ST7558Emulator::endTransmission(void) {
+
+    if (_open && _addressed && !_control && _continue) {
+        _errors++;                          // a control byte announced a byte that never came
+    }
+    _open = false;
+}
+
+/**************************************************************/
+/** @brief Decode a mock bus log. A START without a STOP before
+           it (repeated START) begins a new transaction, as on
+           the controller
+*/
+/**************************************************************/
+void ST7558Emulator::feed(const std::vector<TwoWire::Event> &events) {
+
+    for (size_t i = 0; i < events.size(); i++) {
+
+        const TwoWire::Event &event = events[i];
+        switch (event.kind) {
+            case TwoWire::Event::START:
+                _open = false;
+                break;
+            case TwoWire::Event::ADDRESS:
+                beginTransmission(event.value >> 1);
+                break;
+            case TwoWire::Event::BYTE:
+                write(event.value);
+                break;
+            case TwoWire::Event::STOP:
+                endTransmission();
+                break;
+        }
+    }
+}
+
+/**************************************************************/
+/** @brief This method stores a display data byte and advances
+           the address counters. Horizontal addressing walks a
+           page and wraps to the next one, vertical addressing
+           walks a column; both wrap around the whole RAM
+*/
+/**************************************************************/
+void ST7558Emulator::_writeData(const uint8_t data) {
+
+    _dataBytes++;
+    _ram[_y][_x] = data;
+    if (_vertical) {
+
+        if (++_y >= ST7558_RAM_PAGES) {
+            _y = 0;
+            if (++_x >= ST7558_RAM_WIDTH) {
+                _x = 0;
+            }
+        }
+    } else {
+
+        if (++_x >= ST7558_RAM_WIDTH) {
+            _x = 0;
+            if (++_y >= ST7558_RAM_PAGES) {
+                _y = 0;
+            }
+        }
+    }
+}
+
+/**************************************************************/
+/** @brief This method executes one command byte. Anything the
+           datasheet does not define for the current instruction
+           set is counted as an error
+*/
+/**************************************************************/
+void ST7558Emulator::_command(const uint8_t cmd) {
+
+    _commands++;
+    if (cmd == NOP) {
+        return;
+    }
+    if ((cmd & 0xF8) == ST7558_FUNCTIONSET) {
+
+        _powerDown = cmd & POWER_DOWN_MODE;
+        _vertical = cmd & VERTICAL_ADDRESSING;
+        _extended = cmd & EXTENDED;
+        return;
+    }
+    if ((cmd & 0xF8) == (ST7558_EXTENDED_DISPAY_CONTROL & 0xF8)) {
+
+        _mirrorX = cmd & MIRROR_X;
+        _mirrorY = cmd & MIRROR_Y;
+        return;
+    }
+    if (!_extended) {
+
+        if (cmd & ST7558_XADDR) {
+
+            const uint8_t x = cmd & 0x7F;
+            if (x < ST7558_RAM_WIDTH) {
+                _x = x;
+            } else {
+                _errors++;
+            }
+        } else if ((cmd & 0xF0) == ST7558_YADDR) {
+
+            const uint8_t y = cmd & 0x0F;
+            if (y < ST7558_RAM_PAGES) {
+                _y = y;
+            } else {
+                _errors++;
+            }
+        } else if ((cmd & 0xFA) == ST7558_DISPLAY_CONROL) {
+            _displayMode = cmd;
+        } else if ((cmd & 0xFE) == ST7558_VLCD) {
+            _prs = cmd & VLCD_HIGH;
+        } else {
+            _errors++;
+        }
+    } else {
+
+        if (cmd & ST7558_VOP) {
+            _vop = cmd & 0x7F;
+        } else if ((cmd & 0xF8) == (ST7558_SYSTEM_BIAS & 0xF8)) {
+            _bias = cmd & 0x07;
+        } else if ((cmd & 0xFC) == ST7558_BOOST) {
+            _boost = cmd & 0x03;
+        } else {
+            _errors++;
+        }
+    }
+}
+
+/**************************************************************/
+/** @brief Get a display data RAM byte
+*/
+/**************************************************************/
+uint8_t ST7558Emulator::ram(const uint8_t page, const uint8_t column) const {
+
+    return (page < ST7558_RAM_PAGES && column < ST7558_RAM_WIDTH) ? _ram[page][column] : 0;
+}
+
+/**************************************************************/
+/** @brief Get the RAM bit behind a pixel of the glass. The
+           module is mounted for the MX = MY = 1 that begin()
+           sends: then column x shows RAM column columnOffset + x
+           and row y RAM row y. Clearing MX or MY mirrors that
+           axis over the whole 102x66 RAM
+*/
+/**************************************************************/
+bool ST7558Emulator::pixel(const uint8_t x, const uint8_t y) const {
+
+    if (x >= _width || y >= _height) {
+        return false;
+    }
+    const uint8_t column = _mirrorX ? _columnOffset + x : ST7558_RAM_WIDTH - 1 - _columnOffset - x;
+    const uint8_t row = _mirrorY ? y : ST7558_RAM_HEIGHT - 1 - y;
+    return (_ram[row / 8][column] >> (row % 8)) & 1;
+}
+
+/**************************************************************/
+/** @brief Get whether a pixel of the glass is dark, after power
+           down and the display mode
+*/
+/**************************************************************/
+bool ST7558Emulator::glass(const uint8_t x, const uint8_t y) const {
+
+    if (_powerDown) {
+        return false;
+    }
+    switch (_displayMode) {
+        case ON:            return pixel(x, y);
+        case INVERT:        return !pixel(x, y);
+        case ALL_SEG_ON:    return x < _width && y < _height;
+        default:            return false;
+    }
+}
+
+/**************************************************************/
+/** @brief Count the pixels of the glass whose RAM bit differs
+           from a page-major frame of width x height (a driver
+           framebuffer). The display mode is not applied
+*/
+/**************************************************************/
+uint16_t ST7558Emulator::compare(const uint8_t *frame) const {
+
+    uint16_t differ = 0;
+    for (uint8_t y = 0; y < _height; y++) {
+        for (uint8_t x = 0; x < _width; x++) {
+
+            const bool bit = (frame[(y / 8) * _width + x] >> (y % 8)) & 1;
+            differ += bit != pixel(x, y);
+        }
+    }
+    return differ;
+}
+
+/**************************************************************/
+/** @brief Save the glass as a binary PBM (P4), dark pixels black
+    @return false if the file can't be written
+*/
+/**************************************************************/
+bool ST7558Emulator::writePBM(const char *path) const {
+
+    FILE *file = fopen(path, "wb");
+    if (!file) {
+        return false;
+    }
+    fprintf(file, "P4\n%u %u\n", _width, _height);
+    for (uint8_t y = 0; y < _height; y++) {
+
+        uint8_t bits = 0;
+        for (uint8_t x = 0; x < _width; x++) {
+
+            bits = (bits << 1) | glass(x, y);
+            if (x % 8 == 7 || x == _width - 1) {
+                fputc(bits << (7 - x % 8), file);
+                bits = 0;
+            }
+        }
+    }
+    return fclose(file) == 0;
+}
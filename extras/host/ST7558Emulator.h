@@ -0,0 +1,68 @@
+/**
+ * @file ST7558Emulator.h
+ *
+ * Software model of the ST7558 controller for the Linux host build. It
+ * decodes the I2C byte stream the driver emits (control bytes with the Co
+ * and D/C bits, the basic and extended instruction sets) into a 102x66
+ * display data RAM, and shows what the glass of the module would show.
+ * Feed it the mock bus log to check that an optimized flush leaves the
+ * same picture on the panel as the framebuffer, or export a PBM for
+ * golden-image comparisons.
+ */
+
+#ifndef ST7558_EMULATOR_H
+#define ST7558_EMULATOR_H
+
+#include <ST7558.h>
+#include <Wire.h>
+#include <stdint.h>
+
+class ST7558Emulator {
+
+    private:
+
+        uint8_t _ram[ST7558_RAM_PAGES][ST7558_RAM_WIDTH];
+        uint8_t _width, _height, _columnOffset;
+        uint8_t _x, _y;                     // address counters
+        bool _powerDown, _vertical, _extended;
+        bool _mirrorX, _mirrorY;
+        uint8_t _displayMode;               // D and E bits of display control
+        uint8_t _vop, _bias, _boost, _prs;
+        bool _open, _addressed;             // transaction state
+        bool _control, _continue, _data;    // next byte is a control byte; its Co and D/C
+        uint32_t _transactions, _dataBytes, _commands, _errors;
+
+        void _command(uint8_t cmd);
+        void _writeData(uint8_t data);
+
+    public:
+
+        ST7558Emulator(uint8_t width = ST7558_WIDTH, uint8_t height = ST7558_HEIGHT,
+                       uint8_t columnOffset = ST7558_COLUMN_OFFSET);
+
+        void reset(void);
+        void beginTransmission(uint8_t address);
+        void write(uint8_t data);
+        void endTransmission(void);
+        void feed(const std::vector<TwoWire::Event> &events);
+
+        uint8_t ram(uint8_t page, uint8_t column) const;
+        bool pixel(uint8_t x, uint8_t y) const;
+        bool glass(uint8_t x, uint8_t y) const;
+        uint16_t compare(const uint8_t *frame) const;
+        bool writePBM(const char *path) const;
+
+        uint8_t width(void) const { return _width; }
+        uint8_t height(void) const { return _height; }
+        bool powerDown(void) const { return _powerDown; }
+        bool mirrorX(void) const { return _mirrorX; }
+        bool mirrorY(void) const { return _mirrorY; }
+        uint8_t displayMode(void) const { return _displayMode; }
+        uint8_t vop(void) const { return _vop; }
+        uint32_t transactions(void) const { return _transactions; }
+        uint32_t dataBytes(void) const { return _dataBytes; }
+        uint32_t commands(void) const { return _commands; }
+        uint32_t errors(void) const { return _errors; }
+};
+
+#endif
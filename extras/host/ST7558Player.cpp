@@ -0,0 +1,187 @@
+/**
+ * @file ST7558Player.cpp
+ *
+ * Recording decoder, see ST7558Player.h
+ */
+
+#include "ST7558Player.h"
+#include <ST7558.h>
+#include <stdio.h>
+#include <algorithm>
+
+ST7558Player::ST7558Player(const uint8_t *data, size_t size) :
+    _data(data), _size(size), _width(0), _height(0) {
+
+    if (_size >= ST7558_REC_HEADER && _data[0] == ST7558_REC_MAGIC && _data[1] == ST7558_REC_VERSION) {
+        _width = _data[2];
+        _height = _data[3];
+    }
+    rewind();
+}
+
+/**************************************************************/
+/** @brief Check the recording header
+    @return false if it isn't a recording this player reads
+*/
+/**************************************************************/
+bool ST7558Player::valid(void) const {
+
+    return _width && _height;
+}
+
+/**************************************************************/
+/** @brief Go back to the blank frame before the first record
+*/
+/**************************************************************/
+void ST7558Player::rewind(void) {
+
+    _pos = ST7558_REC_HEADER;
+    _frame.assign(_width * ((_height + 7) / 8), 0);
+    _index = 0;
+    _millis = 0;
+    _frames = 0;
+    _errors = 0;
+}
+
+/**************************************************************/
+/** @brief Apply the next frame record. Bytes that don't start a
+           record, and records that run past the frame or the
+           data, count as errors; decoding picks up at the next
+           record mark
+    @return false at the end of the recording
+*/
+/**************************************************************/
+bool ST7558Player::next(void) {
+
+    if (!valid()) {
+        return false;
+    }
+    while (_pos < _size) {
+
+        if (_data[_pos] != ST7558_REC_FRAME && _data[_pos] != ST7558_REC_KEY) {
+            _errors++;
+            _pos++;
+            continue;
+        }
+        if (_decode()) {
+            _frames++;
+            return true;
+        }
+        _errors++;
+    }
+    return false;
+}
+
+/**************************************************************/
+/** @brief This method decodes the record at _pos into the frame
+    @return false if it is cut short or corrupt, _pos is then one
+            past its mark
+*/
+/**************************************************************/
+bool ST7558Player::_decode(void) {
+
+    const size_t start = _pos;
+    if (_size - _pos < ST7558_REC_RECORD) {
+        _pos = _size;
+        return false;
+    }
+    const uint8_t *p = &_data[_pos + 1];
+    const uint16_t index = p[0] | (p[1] << 8);
+    const uint32_t millis = p[2] | (p[3] << 8) | (p[4] << 16) | ((uint32_t)p[5] << 24);
+    size_t pos = _pos + ST7558_REC_RECORD;
+    size_t at = 0;
+
+    std::vector<uint8_t> frame(_frame);
+    if (_data[_pos] == ST7558_REC_KEY) {
+        std::fill(frame.begin(), frame.end(), 0);
+    }
+    while (pos < _size) {
+
+        const uint8_t code = _data[pos++];
+        if (code == ST7558_REC_END) {
+            _frame.swap(frame);
+            _index = index;
+            _millis = millis;
+            _pos = pos;
+            return true;
+        }
+        const uint8_t n = (code & (ST7558_REC_RUN - 1)) + 1;
+        if (code >= ST7558_REC_KEY || at + n > frame.size()) {
+            break;
+        }
+        if (code >= ST7558_REC_LITERAL && code < ST7558_REC_LITERAL + ST7558_REC_RUN) {
+
+            if (pos + n > _size) {
+                break;
+            }
+            for (uint8_t i = 0; i < n; i++) {
+                frame[at++] ^= _data[pos++];
+            }
+        } else if (code >= ST7558_REC_REPEAT && code < ST7558_REC_LITERAL) {
+
+            if (pos >= _size) {
+                break;
+            }
+            const uint8_t delta = _data[pos++];
+            for (uint8_t i = 0; i < n; i++) {
+                frame[at++] ^= delta;
+            }
+        } else if (code < ST7558_REC_REPEAT) {
+            at += n;
+        } else {
+            break;
+        }
+    }
+    _pos = start + 1;
+    return false;
+}
+
+bool ST7558Player::pixel(const uint8_t x, const uint8_t y) const {
+
+    return (_frame[(y / 8) * _width + x] >> (y % 8)) & 1;
+}
+
+/**************************************************************/
+/** @brief Count the pixels where a page-major frame of the same
+           size differs from the decoded one
+*/
+/**************************************************************/
+uint16_t ST7558Player::compare(const uint8_t *frame) const {
+
+    uint16_t differ = 0;
+    for (uint8_t y = 0; y < _height; y++) {
+        for (uint8_t x = 0; x < _width; x++) {
+
+            const bool bit = (frame[(y / 8) * _width + x] >> (y % 8)) & 1;
+            differ += bit != pixel(x, y);
+        }
+    }
+    return differ;
+}
+
+/**************************************************************/
+/** @brief Save the frame as a binary PBM (P4), set pixels black
+    @return false if the file can't be written
+*/
+/**************************************************************/
+bool ST7558Player::writePBM(const char *path) const {
+
+    FILE *file = fopen(path, "wb");
+    if (!file) {
+        return false;
+    }
+    fprintf(file, "P4\n%u %u\n", _width, _height);
+    for (uint8_t y = 0; y < _height; y++) {
+
+        uint8_t bits = 0;
+        for (uint8_t x = 0; x < _width; x++) {
+
+            bits = (bits << 1) | pixel(x, y);
+            if (x % 8 == 7 || x == _width - 1) {
+                fputc(bits << (7 - x % 8), file);
+                bits = 0;
+            }
+        }
+    }
+    return fclose(file) == 0;
+}
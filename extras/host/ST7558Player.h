@@ -0,0 +1,54 @@
+/**
+ * @file ST7558Player.h
+ *
+ * Decoder for the frame recordings of ST7558::startRecording() (build the
+ * driver with ST7558_ENABLE_RECORDER) and the animations of
+ * extras/host/encoder, format in ST7558Delta.h. It rebuilds the page-major
+ * frames one by one from a recording in memory, so a glitch seen on a unit
+ * in the field can be stepped through on the host, or the frames exported
+ * as PBM images.
+ */
+
+#ifndef ST7558_PLAYER_H
+#define ST7558_PLAYER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+class ST7558Player {
+
+    private:
+
+        const uint8_t *_data;
+        size_t _size, _pos;
+        uint8_t _width, _height;
+        std::vector<uint8_t> _frame;        // page-major, _width bytes per page
+        uint16_t _index;                    // frame number as recorded
+        uint32_t _millis;
+        uint32_t _frames, _errors;
+
+        bool _decode(void);
+
+    public:
+
+        ST7558Player(const uint8_t *data, size_t size);
+
+        bool valid(void) const;
+        bool next(void);
+        void rewind(void);
+
+        const uint8_t *frame(void) const { return _frame.data(); }
+        bool pixel(uint8_t x, uint8_t y) const;
+        uint16_t compare(const uint8_t *frame) const;
+        bool writePBM(const char *path) const;
+
+        uint8_t width(void) const { return _width; }
+        uint8_t height(void) const { return _height; }
+        uint16_t index(void) const { return _index; }
+        uint32_t millis(void) const { return _millis; }
+        uint32_t frames(void) const { return _frames; }
+        uint32_t errors(void) const { return _errors; }
+};
+
+#endif
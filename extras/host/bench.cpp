@@ -0,0 +1,1047 @@
+/**
+ * @file bench.cpp
+ *
+ * Host benchmark for the ST7558 driver. Draw primitives are timed on the
+ * host CPU; flushes are run against the mock TwoWire, which reports the
+ * bytes and transactions put on the bus and the modeled bus time at
+ * 100/300/400 kHz. Absolute host timings are not MCU timings, but ratios
+ * between runs catch throughput regressions before hardware testing.
+ * The same flushes are decoded by a controller emulator to check that the
+ * panel ends up showing the framebuffer.
+ */
+
+#include <Adafruit_GFX.h>
+#include <ST7558.h>
+#include <ST7558Tiles.h>
+#include <ST7558Canvas.h>
+#include <ST7558Console.h>
+#include <ST7558Animation.h>
+#include <Wire.h>
+#include <logo.h>
+#include <stdio.h>
+#include "ST7558Emulator.h"
+#include "ST7558Player.h"
+#include <chrono>
+
+static ST7558 lcd(A3);
+static uint8_t logoPages[snake_logo_w * ((snake_logo_h + 7) / 8)];
+#ifndef ST7558_STRIP_PAGES
+static uint8_t frameA[ST7558_WIDTH * ST7558_PAGES];
+static uint8_t frameB[ST7558_WIDTH * ST7558_PAGES];
+static ST7558TileLayer tiles(lcd);
+static ST7558Console console(lcd);
+
+// blank, brick and dotted floor tiles, and an 8x8 ball, page-major
+static const uint8_t tileset[] PROGMEM = {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0xFF, 0x11, 0x11, 0x11, 0xFF, 0x88, 0x88, 0x88,
+    0x00, 0x00, 0x00, 0x10, 0x00, 0x00, 0x00, 0x01
+};
+static const uint8_t ball[] PROGMEM = { 0x3C, 0x7E, 0xFF, 0xFF, 0xFF, 0xFF, 0x7E, 0x3C };
+#endif
+
+template <class F>
+static double nsPerOp(uint32_t iterations, F body) {
+
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < iterations; i++) {
+        body(i);
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / iterations;
+}
+
+static void header(const char *title) {
+
+    printf("\n%s\n", title);
+}
+
+static void drawResult(const char *name, double ns) {
+
+    printf("  %-34s %10.1f ns/op\n", name, ns);
+}
+
+/**************************************************************/
+/** @brief Draw the same mixed scene on the driver or on a canvas:
+           fills, outlines, text, bitmaps and blits with their
+           default raster op
+*/
+/**************************************************************/
+template <class T>
+static void mixedScene(T &target, uint32_t i) {
+
+    target.fillScreen(WHITE);
+    target.fillRect(10 + i % 20, 4, 24, 20, BLACK);
+    target.blit(12 + i % 17, 6 + (i & 7), logoPages, 16, 16);
+    target.blit(40 + i % 9, 30 - (i & 3), logoPages, 16, 16, ST7558_ROP_XOR, logoPages + 8);
+    target.drawRoundRect(2 + i % 5, 28, 30, 2 + i % 13, i % 7, BLACK);
+    target.fillRoundRect(60, 2 + i % 11, 2 + i % 19, 2 + i % 9, i % 5, BLACK);
+    target.drawCircle(70, 40, i % 14, BLACK);
+    target.drawRect(1, 1, 50 + i % 40, 30 + i % 30, INVERSE);
+    target.drawBitmap(i % 60, 45, snake_logo, snake_logo_w, 16, BLACK);
+    target.drawLine(0, 64, 95, i % 65, INVERSE);
+    target.setTextColor(BLACK);
+    target.setCursor(3, 40);
+    target.print(F("Abc"));
+    target.setTextColor(WHITE, BLACK);
+    target.cp437(i & 1);
+    target.write(170 + i % 20);
+    target.print(i);
+    target.cp437(false);
+}
+
+#ifndef ST7558_STRIP_PAGES
+
+/**************************************************************/
+/** @brief Run one flush scenario: 'setup' prepares the frame,
+           then 'flush' is timed and its bus traffic reported
+*/
+/**************************************************************/
+template <class F, class G>
+static void flushResult(const char *name, F setup, G flush) {
+
+    const uint32_t iterations = 200;
+    double ns = 0;
+    uint32_t bytes = 0, transactions = 0;
+    double bus100 = 0, bus300 = 0, bus400 = 0;
+
+    for (uint32_t i = 0; i < iterations; i++) {
+
+        setup(i);
+        Wire.reset();
+        ns += nsPerOp(1, [&](uint32_t) { flush(); });
+        bytes += Wire.bytes();
+        transactions += Wire.transactions();
+        bus100 += Wire.busMicros(100000);
+        bus300 += Wire.busMicros(300000);
+        bus400 += Wire.busMicros(400000);
+    }
+    printf("  %-34s %10.1f ns/op %6u B %4u tx %9.0f %9.0f %9.0f us\n", name,
+           ns / iterations, bytes / iterations, transactions / iterations,
+           bus100 / iterations, bus300 / iterations, bus400 / iterations);
+}
+
+template <class F>
+static void flushResult(const char *name, F setup) {
+    flushResult(name, setup, []() { lcd.display(); });
+}
+
+static void snakeFrame(uint32_t i) {
+
+    lcd.clearDisplay();
+    lcd.drawLine(0, 9, 95, 9, BLACK);
+    lcd.setCursor(1, 1);
+    lcd.print(F("Score:"));
+    lcd.print(12);
+    lcd.setCursor(72, 1);
+    lcd.print(23);
+    lcd.print("fps");
+    for (uint8_t k = 0; k < 12; k++) {
+        lcd.fillRect(10 + 3 * ((i + k) % 25), 34, 3, 3, BLACK);
+    }
+    lcd.drawRect(61, 22, 3, 3, BLACK);
+}
+
+/**************************************************************/
+/** @brief Copy what 'target' shows to a page-major frame, with
+           getPixel(), as getBuffer() would make the next flush a
+           full one
+*/
+/**************************************************************/
+static void snapshot(ST7558 &target, uint8_t *frame) {
+
+    memset(frame, 0, ST7558_BUFFER_SIZE);
+    for (uint8_t y = 0; y < ST7558_HEIGHT; y++) {
+        for (uint8_t x = 0; x < ST7558_WIDTH; x++) {
+            frame[(y / 8) * ST7558_WIDTH + x] |= target.getPixel(x, y) << (y % 8);
+        }
+    }
+}
+
+/**************************************************************/
+/** @brief Draw 100 frames on 'target', send each with 'flush'
+           and decode the bus log with a controller emulator. 
+           Reports the pixels where the panel and the frame drawn 
+           disagree, and saves the last picture if 'pbm' is set
+    @return false if the picture couldn't be saved
+*/
+/**************************************************************/
+template <class F, class G>
+static bool emulatorResult(const char *name, ST7558 &target, F draw, G flush, 
+                           const char *pbm = NULL) {
+
+    static uint8_t expected[ST7558_BUFFER_SIZE];
+    const uint32_t frames = 100;
+    uint32_t differ = 0, bytes = 0;
+    ST7558Emulator panel;
+
+    Wire.reset();
+    target.begin();
+    panel.feed(Wire.events());
+    for (uint32_t i = 0; i < frames; i++) {
+
+        draw(i);
+        snapshot(target, expected);
+        Wire.reset();
+        flush();
+        bytes += Wire.bytes();
+        panel.feed(Wire.events());
+        differ += panel.compare(expected);
+    }
+    printf("  %-34s %10u px differ %4u errors %6u B/frame\n", name, differ, panel.errors(), 
+           bytes / frames);
+    if (pbm && !panel.writePBM(pbm)) {
+        printf("  can't write %s\n", pbm);
+        return false;
+    }
+    return true;
+}
+
+/**************************************************************/
+/** @brief Draw 20 frames of random rects and pixels at rotation
+           'r' and mirrored by 'mx'/'my', flush each and compare
+           the emulated glass with where Adafruit_GFX puts each
+           pixel: rotated clockwise, then mirrored. A rotation
+           that isn't applied counts every pixel whose place it
+           would change
+*/
+/**************************************************************/
+static void rotationResult(const char *name, uint8_t r, bool mx, bool my) {
+
+    static bool expected[ST7558_WIDTH][ST7558_WIDTH];
+    const uint32_t frames = 20;
+    uint32_t differ = 0;
+    ST7558Emulator panel;
+
+    Wire.reset();
+    lcd.begin();
+    lcd.setRotation(r);
+    lcd.setMirror(mx, my);
+    panel.feed(Wire.events());
+    const int16_t w = (r & 1) ? ST7558_HEIGHT : ST7558_WIDTH;
+    const int16_t h = (r & 1) ? ST7558_WIDTH : ST7558_HEIGHT;
+    const bool turned = lcd.width() == w && lcd.height() == h;
+    for (uint32_t i = 0; i < frames; i++) {
+
+        srand(i);
+        lcd.fillScreen(WHITE);
+        memset(expected, 0, sizeof(expected));
+        for (uint8_t k = 1 + rand() % 6; k; k--) {
+
+            const int16_t x = rand() % w, y = rand() % h;
+            const int16_t rw = 1 + rand() % 30, rh = 1 + rand() % 20;
+            const bool color = rand() & 1;
+            lcd.fillRect(x, y, rw, rh, color);
+            for (int16_t ly = y; ly < y + rh && ly < h; ly++) {
+                for (int16_t lx = x; lx < x + rw && lx < w; lx++) {
+                    expected[lx][ly] = color;
+                }
+            }
+        }
+        for (uint8_t k = 0; k < 20; k++) {
+
+            const int16_t x = rand() % w, y = rand() % h;
+            lcd.drawPixel(x, y, BLACK);
+            expected[x][y] = true;
+        }
+        Wire.reset();
+        lcd.display();
+        panel.feed(Wire.events());
+        for (int16_t ly = 0; ly < h; ly++) {
+            for (int16_t lx = 0; lx < w; lx++) {
+
+                int16_t px = lx, py = ly;
+                switch (r) {
+                    case 1: px = ST7558_WIDTH - 1 - ly; py = lx; break;
+                    case 2: px = ST7558_WIDTH - 1 - lx; py = ST7558_HEIGHT - 1 - ly; break;
+                    case 3: px = ly; py = ST7558_HEIGHT - 1 - lx; break;
+                }
+                if (mx) {
+                    px = ST7558_WIDTH - 1 - px;
+                }
+                if (my) {
+                    py = ST7558_HEIGHT - 1 - py;
+                }
+                differ += panel.glass(px, py) != expected[lx][ly];
+            }
+        }
+    }
+    lcd.setMirror(false, false);
+    lcd.setRotation(0);
+    printf("  %-34s %10u px differ %4u errors%s\n", name, differ, panel.errors(),
+           turned ? "" : ", width()/height() not turned");
+}
+
+/**************************************************************/
+/** @brief Draw 100 frames of the mixed scene on the driver and
+           on a canvas of the panel's size, and count the pixels
+           where they disagree
+*/
+/**************************************************************/
+static void canvasResult(const char *name) {
+
+    static ST7558Canvas canvas(ST7558_WIDTH, ST7558_HEIGHT);
+    uint32_t differ = 0;
+    for (uint32_t i = 0; i < 100; i++) {
+
+        mixedScene(lcd, i);
+        mixedScene(canvas, i);
+        for (uint8_t y = 0; y < ST7558_HEIGHT; y++) {
+            for (uint8_t x = 0; x < ST7558_WIDTH; x++) {
+                differ += lcd.getPixel(x, y) != canvas.getPixel(x, y);
+            }
+        }
+    }
+    lcd.setTextColor(BLACK);
+    printf("  %-34s %10u px differ\n", name, differ);
+}
+
+#ifdef ST7558_ENABLE_STATS
+// Print target for printStats()
+class StdoutPrint : public Print {
+
+    public:
+
+        size_t write(uint8_t c) { return fputc(c, stdout) == EOF ? 0 : 1; }
+};
+#endif
+
+// Recording and animation sink
+class MemoryPrint : public Print {
+
+    public:
+
+        std::vector<uint8_t> data;
+
+        size_t write(uint8_t c) { data.push_back(c); return 1; }
+        size_t write(const uint8_t *buffer, size_t size) {
+            data.insert(data.end(), buffer, buffer + size);
+            return size;
+        }
+};
+
+// Animation source that hands out 'chunk' more bytes per poll, like a
+// serial line
+class MemoryStream : public Stream {
+
+    public:
+
+        const std::vector<uint8_t> &data;
+        size_t pos, limit, chunk;
+
+        MemoryStream(const std::vector<uint8_t> &data, size_t chunk) :
+            data(data), pos(0), limit(0), chunk(chunk) {}
+
+        void poll(void) { limit = (limit + chunk < data.size()) ? limit + chunk : data.size(); }
+        int available(void) { return limit - pos; }
+        int read(void) { return (pos < limit) ? data[pos++] : -1; }
+        int peek(void) { return (pos < limit) ? data[pos] : -1; }
+        size_t write(uint8_t) { return 0; }
+};
+
+static uint8_t animationFrames[100][ST7558_BUFFER_SIZE];
+static ST7558Animation animation(lcd);
+
+/**************************************************************/
+/** @brief Play 100 frames of an animation, flush each and decode
+           the bus log with a controller emulator. Reports the
+           pixels where the panel and the source frames disagree,
+           and the decode calls per frame. 'poll' runs before each
+           call, e.g. to hand a stream more bytes
+*/
+/**************************************************************/
+template <class F>
+static void animationResult(const char *name, F poll) {
+
+    const uint32_t frames = 100;
+    uint32_t differ = 0, bytes = 0, calls = 0;
+    ST7558Emulator panel;
+
+    Wire.setRecording(true);
+    Wire.reset();
+    lcd.begin();
+    panel.feed(Wire.events());
+    for (uint32_t i = 0; i < frames; i++) {
+
+        do {
+            poll();
+            calls++;
+        } while (!animation.nextFrame() && animation.isPlaying() && calls < 100 * frames);
+        Wire.reset();
+        lcd.display();
+        bytes += Wire.bytes();
+        panel.feed(Wire.events());
+        differ += panel.compare(animationFrames[i]);
+    }
+    Wire.setRecording(false);
+    printf("  %-34s %10u px differ %4u errors %6u B/frame %5.1f calls/frame\n", name, differ,
+           panel.errors(), bytes / frames, (double)calls / frames);
+}
+
+/**************************************************************/
+/** @brief Play a looping flash animation that can't be decoded
+           for a few update() and nextFrame() calls. Reports the
+           frames decoded and whether the player stopped; a
+           player that spins on it never gets here
+*/
+/**************************************************************/
+static void brokenAnimationResult(const char *name, const uint8_t *data, uint16_t size) {
+
+    animation.begin(data, size);
+    animation.setLoop(true);
+    for (uint8_t i = 0; i < 4; i++) {
+        animation.update();
+        animation.nextFrame();
+    }
+    printf("  %-34s %10u frames, %s\n", name, animation.getFrame(),
+           animation.isPlaying() ? "still playing" : "stopped");
+}
+
+#ifdef ST7558_ENABLE_RECORDER
+static uint8_t recordReference[ST7558_BUFFER_SIZE];
+
+/**************************************************************/
+/** @brief Record 100 frames of 'draw', replay the recording and
+           report the pixels where the replayed frames and the
+           framebuffer disagree, and the recorded bytes per frame
+*/
+/**************************************************************/
+template <class F>
+static void recorderResult(const char *name, F draw, MemoryPrint &sink) {
+
+    static uint8_t expected[100][ST7558_BUFFER_SIZE];
+    const uint32_t frames = 100;
+    uint32_t differ = 0;
+
+    sink.data.clear();
+    lcd.startRecording(sink, recordReference);
+    for (uint32_t i = 0; i < frames; i++) {
+
+        draw(i);
+        snapshot(lcd, expected[i]);
+        lcd.display();
+    }
+    lcd.stopRecording();
+
+    // flushes that changed nothing are not recorded, the screen stays
+    ST7558Player player(sink.data.data(), sink.data.size());
+    uint8_t shown[ST7558_BUFFER_SIZE] = { 0 };
+    uint32_t i = 0, replayed = 0;
+    while (i < frames) {
+
+        const bool more = player.next();
+        const uint32_t until = more ? player.index() : frames;
+        for (; i < until && i < frames; i++) {
+            for (uint16_t k = 0; k < ST7558_BUFFER_SIZE; k++) {
+                differ += __builtin_popcount(shown[k] ^ expected[i][k]);
+            }
+        }
+        if (!more) {
+            break;
+        }
+        differ += player.compare(expected[i++]);
+        memcpy(shown, player.frame(), ST7558_BUFFER_SIZE);
+        replayed++;
+    }
+    printf("  %-34s %10u px differ %4u errors %6u B/frame %3u frames\n", name, differ, 
+           player.errors(), (unsigned)(sink.data.size() / frames), replayed);
+}
+#endif
+
+#ifdef ST7558_ENABLE_PIPELINE
+static uint8_t backBuffer[ST7558_BUFFER_SIZE];
+
+// stands in for game logic, input and the like between frames
+static void appWork(uint32_t us) {
+
+    const uint32_t start = micros();
+    while (micros() - start < us);
+}
+
+// every column changes each frame, the bus is the bottleneck
+static void stripesFrame(uint32_t i) {
+
+    for (uint8_t x = 0; x < ST7558_WIDTH; x++) {
+        lcd.drawFastVLine(x, 0, ST7558_HEIGHT, ((x + i) >> 2) & 1);
+    }
+}
+
+/**************************************************************/
+/** @brief Run 100 frames of app work + 'draw' against the 
+           real-time mock bus and report the frame rate reached
+*/
+/**************************************************************/
+static void pipelineResult(const char *name, void (*draw)(uint32_t), bool present) {
+
+    const uint32_t frames = 100;
+    Wire.reset();
+    const uint32_t start = micros();
+    for (uint32_t i = 0; i < frames; i++) {
+        appWork(3000);
+        draw(i);
+        if (present) {
+            lcd.present();
+        } else {
+            lcd.display();
+        }
+    }
+    lcd.waitFlush();
+    const uint32_t us = micros() - start;
+    printf("  %-34s %10.1f fps %6u B/frame %4u skipped\n", name, frames * 1e6 / us, 
+           Wire.bytes() / frames, present ? lcd.getSkippedFrames() : 0);
+}
+
+/**************************************************************/
+/** @brief Same frames drawn and sent on one thread, then with
+           the flush thread under both frame policies
+*/
+/**************************************************************/
+static void pipelineResults(const char *frame, void (*draw)(uint32_t)) {
+
+    char name[40];
+    lcd.setBackBuffer(backBuffer);
+    snprintf(name, sizeof(name), "%s, display()", frame);
+    pipelineResult(name, draw, false);
+    lcd.startFlushTask(backBuffer, ST7558_WAIT_FRAME);
+    snprintf(name, sizeof(name), "%s, present() wait", frame);
+    pipelineResult(name, draw, true);
+    lcd.stopFlushTask();
+    lcd.startFlushTask(backBuffer, ST7558_SKIP_FRAME);
+    snprintf(name, sizeof(name), "%s, present() skip", frame);
+    pipelineResult(name, draw, true);
+    lcd.stopFlushTask();
+    lcd.setBackBuffer(NULL);
+}
+#endif
+
+int main(int argc, char **argv) {
+
+    Wire.setRecording(false);
+    lcd.begin();
+    lcd.setTextColor(BLACK);
+
+    header("draw primitives (host CPU)");
+    drawResult("drawPixel", nsPerOp(200000, [](uint32_t i) {
+        lcd.drawPixel(i % ST7558_WIDTH, (i / ST7558_WIDTH) % ST7558_HEIGHT, i & 1);
+    }));
+    drawResult("fillRect 3x3", nsPerOp(50000, [](uint32_t i) {
+        lcd.fillRect(i % 90, (i / 90) % 60, 3, 3, BLACK);
+    }));
+    drawResult("fillRect 20x20", nsPerOp(20000, [](uint32_t i) {
+        lcd.fillRect(i % 70, (i / 70) % 40, 20, 20, i & 1);
+    }));
+    drawResult("fillRect 20x20 INVERSE", nsPerOp(20000, [](uint32_t i) {
+        lcd.fillRect(i % 70, (i / 70) % 40, 20, 20, INVERSE);
+    }));
+    drawResult("fillRect full screen", nsPerOp(5000, [](uint32_t i) {
+        lcd.fillRect(0, 0, ST7558_WIDTH, ST7558_HEIGHT, i & 1);
+    }));
+    drawResult("drawRect 40x30", nsPerOp(20000, [](uint32_t i) {
+        lcd.drawRect(i % 50, (i / 50) % 30, 40, 30, BLACK);
+    }));
+    drawResult("drawRoundRect 45x12", nsPerOp(20000, [](uint32_t i) {
+        lcd.drawRoundRect(i % 50, (i / 50) % 50, 45, 12, 2, i & 1);
+    }));
+    drawResult("drawLine diagonal", nsPerOp(20000, [](uint32_t) {
+        lcd.drawLine(0, 0, ST7558_WIDTH - 1, ST7558_HEIGHT - 1, BLACK);
+    }));
+    drawResult("drawBitmap snake_logo", nsPerOp(5000, [](uint32_t i) {
+        lcd.drawBitmap(14 + (i & 1), 2 + (i & 2), snake_logo, snake_logo_w, snake_logo_h, BLACK);
+    }));
+    ST7558::toPageMajor(snake_logo, snake_logo_w, snake_logo_h, logoPages);
+    drawResult("blit page-major snake_logo", nsPerOp(5000, [](uint32_t i) {
+        lcd.blit(14 + (i & 1), 2 + (i & 2), logoPages, snake_logo_w, snake_logo_h);
+    }));
+    drawResult("blit XOR sprite with mask 16x16", nsPerOp(20000, [](uint32_t i) {
+        lcd.blit(i % 80, (i / 80) % 49, logoPages, 16, 16, ST7558_ROP_XOR, logoPages + 8);
+    }));
+    drawResult("print \"Score:123\"", nsPerOp(20000, [](uint32_t) {
+        lcd.setCursor(1, 1);
+        lcd.print(F("Score:"));
+        lcd.print(123);
+    }));
+    drawResult("print opaque \"Score:123\"", nsPerOp(20000, [](uint32_t) {
+        lcd.setTextColor(BLACK, WHITE);
+        lcd.setCursor(1, 1);
+        lcd.print(F("Score:"));
+        lcd.print(123);
+        lcd.setTextColor(BLACK);
+    }));
+    drawResult("panel 32x16 drawn directly", nsPerOp(20000, [](uint32_t i) {
+        lcd.fillRect(i % 64, 2, 32, 16, WHITE);
+        lcd.drawRoundRect(i % 64, 2, 32, 16, 3, BLACK);
+        lcd.setCursor(i % 64 + 4, 6);
+        lcd.print(F("HP:9"));
+    }));
+    static ST7558Canvas panel(32, 16);
+    panel.drawRoundRect(0, 0, 32, 16, 3, BLACK);
+    panel.setTextColor(BLACK);
+    panel.setCursor(4, 4);
+    panel.print(F("HP:9"));
+    drawResult("blit cached canvas panel 32x16", nsPerOp(20000, [](uint32_t i) {
+        lcd.blit(i % 64, 2 + (i & 3), panel);
+    }));
+    memset(frameB, 0xA5, sizeof(frameB));
+    drawResult("pushBuffer() frame copy", nsPerOp(20000, [](uint32_t i) {
+        lcd.pushBuffer(i & 1 ? frameA : frameB, sizeof(frameA));
+    }));
+    drawResult("attachBuffer() zero copy", nsPerOp(20000, [](uint32_t i) {
+        lcd.attachBuffer(i & 1 ? frameA : frameB);
+    }));
+    lcd.attachBuffer(NULL);
+    drawResult("clearDisplay", nsPerOp(20000, [](uint32_t) {
+        lcd.fillRect(0, 0, ST7558_WIDTH, ST7558_HEIGHT, BLACK);
+        lcd.clearDisplay();
+    }));
+    drawResult("scrollY one text line", nsPerOp(20000, [](uint32_t) {
+        lcd.scrollY(-8);
+    }));
+    drawResult("scrollY 3 rows", nsPerOp(20000, [](uint32_t) {
+        lcd.scrollY(-3);
+    }));
+    drawResult("scrollX 1 column", nsPerOp(20000, [](uint32_t) {
+        lcd.scrollX(-1);
+    }));
+    drawResult("log repainted, 8 lines of text", nsPerOp(2000, [](uint32_t i) {
+        lcd.clearDisplay();
+        for (uint8_t k = 0; k < 8; k++) {
+            lcd.setCursor(0, k * 8);
+            lcd.print(F("log line "));
+            lcd.print(i + k);
+        }
+    }));
+    drawResult("log scrolled, 1 new line", nsPerOp(2000, [](uint32_t i) {
+        lcd.scrollY(-8);
+        lcd.setCursor(0, 56);
+        lcd.print(F("log line "));
+        lcd.print(i + 7);
+    }));
+
+    header("flush (host CPU, bytes on wire, modeled bus time @ 100k / 300k / 400k)");
+    flushResult("display() full frame", [](uint32_t i) {
+        lcd.fillScreen(i & 1);
+    });
+    flushResult("display() nothing changed", [](uint32_t) {});
+    flushResult("display() one score digit", [](uint32_t i) {
+        lcd.fillRect(37, 1, 6, 8, WHITE);
+        lcd.setCursor(37, 1);
+        lcd.print(i % 10);
+    });
+    flushResult("display() snake frame", snakeFrame);
+    for (uint8_t r = 1; r < 4; r++) {
+
+        // 90/270 are drawn off screen and transposed at flush
+        static const char *names[] = { NULL, "one score digit, rotation 90",
+                                       "one score digit, rotation 180",
+                                       "one score digit, rotation 270" };
+        lcd.setRotation(r);
+        lcd.display();
+        flushResult(names[r], [](uint32_t i) {
+            lcd.fillRect(37, 1, 6, 8, WHITE);
+            lcd.setCursor(37, 1);
+            lcd.print(i % 10);
+        });
+    }
+    lcd.setRotation(0);
+    lcd.display();
+    flushResult("display() log scrolled one line", [](uint32_t i) {
+        lcd.scrollY(-8);
+        lcd.setCursor(0, 56);
+        lcd.print(F("log line "));
+        lcd.print(i);
+    });
+    flushResult("digit + contrast/invert, immediate", [](uint32_t) {}, []() {
+        static uint32_t i = 0;
+        lcd.setContrast(60 + (i & 7));
+        lcd.invertDisplay(i++ & 1);
+        lcd.fillRect(37, 1, 6, 8, WHITE);
+        lcd.setCursor(37, 1);
+        lcd.print(i % 10);
+        lcd.display();
+    });
+    lcd.deferCommands(true);
+    flushResult("digit + contrast/invert, deferred", [](uint32_t) {}, []() {
+        static uint32_t i = 0;
+        lcd.setContrast(60 + (i & 7));
+        lcd.invertDisplay(i++ & 1);
+        lcd.fillRect(37, 1, 6, 8, WHITE);
+        lcd.setCursor(37, 1);
+        lcd.print(i % 10);
+        lcd.display();
+    });
+    lcd.deferCommands(false);
+    lcd.invertDisplay(false);
+    flushResult("display() vertical gauge 4x60", [](uint32_t i) {
+        lcd.fillRect(88, 2, 4, 60, WHITE);
+        lcd.fillRect(88, 62 - (i % 60), 4, i % 60, BLACK);
+    });
+    flushResult("display() sparkline column", [](uint32_t i) {
+        lcd.drawFastVLine(i % ST7558_WIDTH, 0, ST7558_HEIGHT, WHITE);
+        lcd.drawFastVLine(i % ST7558_WIDTH, 10 + (i * 7) % 40, 12, BLACK);
+    });
+    drawResult("displayAsync() + poll() full frame", nsPerOp(200, [](uint32_t i) {
+        lcd.fillScreen(i & 1);
+        lcd.displayAsync();
+        while (lcd.poll());
+    }));
+    flushResult("displayFrame() precomputed frame", [](uint32_t) {}, []() {
+        lcd.displayFrame(frameB);
+    });
+    flushResult("display() snake menu", [](uint32_t i) {
+        lcd.clearDisplay();
+        lcd.drawBitmap(14 + (i & 1), 2 + (i & 2), snake_logo, snake_logo_w, snake_logo_h, BLACK);
+        lcd.drawRoundRect(32, 35, 33, 11, 2, BLACK);
+        lcd.setCursor(34, 37);
+        lcd.print(F("start"));
+        lcd.drawRoundRect(26, 49, 45, 12, 2, BLACK);
+        lcd.setCursor(28, 51);
+        lcd.print(F("options"));
+        lcd.drawRoundRect(31, 34, 35, 13, 2, (i & 1) ? BLACK : WHITE);
+    });
+    flushResult("snake menu highlight, INVERSE", [](uint32_t) {
+        lcd.drawRoundRect(31, 34, 35, 13, 2, INVERSE);
+    });
+    tiles.setTileset(tileset);
+    for (uint8_t ty = 0; ty < ST7558_TILES_Y; ty++) {
+        for (uint8_t tx = 0; tx < ST7558_TILES_X; tx++) {
+            tiles.setTile(tx, ty, (tx == 0 || ty == 0 || tx == ST7558_TILES_X - 1) ? 1 : 2);
+        }
+    }
+    tiles.setSprite(0, 8, 20, ball, 8, 8, ball);
+    tiles.render();
+    lcd.display();
+    drawResult("tile layer: move sprite + render", nsPerOp(20000, [](uint32_t i) {
+        tiles.moveSprite(0, 8 + i % 72, 20 + i % 7);
+        tiles.render();
+    }));
+    flushResult("tile layer: 8x8 sprite moves", [](uint32_t i) {
+        tiles.moveSprite(0, 8 + i % 72, 20 + i % 7);
+        tiles.render();
+    });
+    flushResult("tile layer: one tile changes", [](uint32_t i) {
+        tiles.setTile(1 + i % 10, 6, (i / 10) & 1 ? 2 : 1);
+        tiles.render();
+    });
+    console.invalidate();
+    console.render();
+    lcd.display();
+    drawResult("console: log line + render", nsPerOp(20000, [](uint32_t i) {
+        console.print(F("log line "));
+        console.println(i);
+        console.render();
+    }));
+    flushResult("console: log line", [](uint32_t i) {
+        console.print(F("log line "));
+        console.println(i);
+        console.render();
+    });
+    flushResult("console: a counter counts", [](uint32_t i) {
+        console.setCursor(10, 0);
+        console.print(i);
+        console.render();
+    });
+
+    // same frames through a 128-byte Wire buffer (ESP32-class cores)
+    static ST7558 wide(A3, ST7558WireTransport(Wire, 128), 400000);
+    Wire.setBufferSize(128);
+    wide.begin();
+    flushResult("128 B chunks: full frame", [](uint32_t i) {
+        wide.fillScreen(i & 1);
+    }, []() { wide.display(); });
+    flushResult("128 B chunks: vertical gauge 4x60", [](uint32_t i) {
+        wide.fillRect(88, 2, 4, 60, WHITE);
+        wide.fillRect(88, 62 - (i % 60), 4, i % 60, BLACK);
+    }, []() { wide.display(); });
+    Wire.setBufferSize(BUFFER_LENGTH);
+
+    // begin() on a bus that only ACKs at 100kHz
+    Wire.setMaxClock(100000);
+    ST7558 slow(A3, 400000);
+    const bool ready = slow.begin();
+    Wire.setMaxClock(0xFFFFFFFF);
+    printf("  %-34s %10s %lu Hz\n", "begin() fallback on a slow bus", 
+           ready ? "ready at" : "failed at", (unsigned long)slow.getClock());
+
+    // back from power down: one command, the RAM kept the frame
+    flushResult("wake() from sleep", [](uint32_t) { lcd.sleep(); }, []() { lcd.wake(); });
+    flushResult("begin() + display() instead", [](uint32_t) {}, []() {
+        lcd.begin();
+        lcd.display();
+    });
+
+    header("controller emulator, panel vs framebuffer after each flush");
+    char pbm[256];
+    snprintf(pbm, sizeof(pbm), "%s/snake.pbm", argc > 1 ? argv[1] : ".");
+    Wire.setRecording(true);
+    const bool saved = emulatorResult("display() snake frames", lcd, snakeFrame, []() { 
+        lcd.display(); 
+    }, pbm);
+    emulatorResult("display() random rects", lcd, [](uint32_t i) {
+        srand(i);
+        for (uint8_t k = rand() % 8; k; k--) {
+            lcd.fillRect(rand() % 96, rand() % 65, rand() % 40, rand() % 30, rand() & 1);
+        }
+    }, []() { lcd.display(); });
+    emulatorResult("display() gauge and sparkline", lcd, [](uint32_t i) {
+        lcd.fillRect(88, 2, 4, 60, WHITE);
+        lcd.fillRect(88, 62 - (i % 60), 4, i % 60, BLACK);
+        lcd.drawFastVLine(i % 80, 0, ST7558_HEIGHT, WHITE);
+        lcd.drawFastVLine(i % 80, 10 + (i * 7) % 40, 12, BLACK);
+    }, []() { lcd.display(); });
+    emulatorResult("sleep(), draw, wake() + display()", lcd, snakeFrame, []() {
+        lcd.sleep();
+        lcd.display();
+        lcd.wake();
+        lcd.display();
+    });
+    lcd.deferCommands(true);
+    emulatorResult("digits + deferred contrast/invert", lcd, [](uint32_t i) {
+        lcd.setContrast(60 + (i & 7));
+        lcd.invertDisplay(i & 1);
+        lcd.fillRect(37, 1, 6, 8, WHITE);
+        lcd.setCursor(37, 1);
+        lcd.print(i % 10);
+    }, []() { lcd.display(); });
+    lcd.deferCommands(false);
+    lcd.invertDisplay(false);
+    emulatorResult("displayAsync() + poll()", lcd, snakeFrame, []() {
+        lcd.displayAsync();
+        while (lcd.poll());
+    });
+    emulatorResult("displayFrame(), then display()", lcd, snakeFrame, []() {
+        lcd.displayFrame(frameB);
+        lcd.display();
+    });
+    emulatorResult("tile layer, sprite and tiles", lcd, [](uint32_t i) {
+        if (i == 0) {
+            tiles.invalidate();             // begin() cleared the framebuffer
+        }
+        tiles.moveSprite(0, i % 96 - 4, 20 + i % 19);
+        tiles.setTile(1 + i % 10, 6, (i / 10) & 1 ? 2 : 1);
+        tiles.render();
+    }, []() { lcd.display(); });
+    emulatorResult("console log and scrollback", lcd, [](uint32_t i) {
+        if (i == 0) {
+            console.invalidate();
+        }
+        console.setAttributes(i % 5 ? 0 : ST7558_CONSOLE_INVERSE);
+        console.print(F("line "));
+        console.print(i);
+        console.print(i % 3 ? "\n" : "\tand a wrapped tail\n");
+        console.showCursor(i & 1);
+        console.scrollBack(i % 7);
+        console.render();
+    }, []() { lcd.display(); });
+    emulatorResult("scrolled log and ticker", lcd, [](uint32_t i) {
+        lcd.scrollY(-8);
+        lcd.setCursor(0, 48);
+        lcd.print(F("log line "));
+        lcd.print(i);
+        lcd.scroll(0, 57, ST7558_WIDTH, 8, -3, 0);
+        lcd.fillRect(93, 58 + i % 7, 3, 1, BLACK);
+    }, []() { lcd.display(); });
+    lcd.setBackBuffer(frameA);
+    emulatorResult("double buffered snake frames", lcd, snakeFrame, []() {
+        lcd.display();
+    });
+    lcd.setBackBuffer(NULL);
+    Wire.setBufferSize(128);
+    emulatorResult("128 B chunks: random rects", wide, [](uint32_t i) {
+        srand(i);
+        for (uint8_t k = rand() % 8; k; k--) {
+            wide.fillRect(rand() % 96, rand() % 65, rand() % 40, rand() % 30, rand() & 1);
+        }
+    }, []() { wide.display(); });
+
+    // a buffer size too small for a command queue is raised to the minimum
+    static ST7558 tiny(A3, ST7558WireTransport(Wire, 1));
+    Wire.setBufferSize(ST7558_MIN_BUFFER);
+    const uint32_t overflows = Wire.overflows();
+    emulatorResult("1 B buffer asked: random rects", tiny, [](uint32_t i) {
+        srand(i);
+        for (uint8_t k = rand() % 8; k; k--) {
+            tiny.fillRect(rand() % 96, rand() % 65, rand() % 40, rand() % 30, rand() & 1);
+        }
+        tiny.setContrast(60 + (i & 7));
+    }, []() { tiny.display(); });
+    printf("  %-34s %10u Wire overflows\n", "1 B buffer asked", Wire.overflows() - overflows);
+    Wire.setBufferSize(BUFFER_LENGTH);
+    Wire.setRecording(false);
+    if (saved) {
+        printf("  last snake frame saved to %s\n", pbm);
+    }
+
+    header("rotation and mirroring, emulated glass vs Adafruit_GFX mapping");
+    Wire.setRecording(true);
+    rotationResult("rotation 0", 0, false, false);
+    rotationResult("rotation 90", 1, false, false);
+    rotationResult("rotation 180", 2, false, false);
+    rotationResult("rotation 270", 3, false, false);
+    rotationResult("mirrored left-right", 0, true, false);
+    rotationResult("mirrored top-bottom", 0, false, true);
+    rotationResult("rotation 90, mirrored top-bottom", 1, false, true);
+    rotationResult("rotation 180, mirrored both", 2, true, true);
+    Wire.setRecording(false);
+    lcd.display();
+
+    header("canvas vs driver, same draw calls");
+    canvasResult("mixed scene, default ops");
+
+    header("animation player, 100 snake frames, XOR delta + RLE");
+    MemoryPrint encoded;
+    static uint8_t reference[ST7558_BUFFER_SIZE];
+    ST7558DeltaWriter::header(encoded, ST7558_WIDTH, ST7558_HEIGHT);
+    for (uint32_t i = 0; i < 100; i++) {
+
+        snakeFrame(i);
+        snapshot(lcd, animationFrames[i]);
+        ST7558DeltaWriter out(encoded, i ? ST7558_REC_FRAME : ST7558_REC_KEY, i, i * 40);
+        out.code(animationFrames[i], false, reference, 0, ST7558_BUFFER_SIZE - 1);
+        out.finish(!i);
+    }
+    ST7558DeltaWriter(encoded, ST7558_REC_FRAME, 100, 100 * 40).finish(true);
+    printf("  %-34s %10u B, raw frames %u B\n", "encoded", (unsigned)encoded.data.size(),
+           (unsigned)sizeof(animationFrames));
+    static uint32_t frame;
+    flushResult("pushBuffer() + display()", [](uint32_t i) { frame = i % 100; }, []() {
+        lcd.pushBuffer(animationFrames[frame], ST7558_BUFFER_SIZE);
+        lcd.display();
+    });
+    animation.begin(encoded.data.data(), encoded.data.size());
+    flushResult("nextFrame() + display()", [](uint32_t) {}, []() {
+        animation.nextFrame();
+        lcd.display();
+    });
+    animation.begin(encoded.data.data(), encoded.data.size());
+    animationResult("played from flash", []() {});
+    MemoryStream stream(encoded.data, 16);
+    animation.begin(stream);
+    animationResult("played from a stream, 16 B per poll", [&]() { stream.poll(); });
+    static const uint8_t badCode[] = { ST7558_REC_MAGIC, ST7558_REC_VERSION, ST7558_WIDTH,
+                                       ST7558_HEIGHT, ST7558_REC_KEY, 0, 0, 0, 0, 0, 0, 0xC0 };
+    brokenAnimationResult("looping, bad code", badCode, sizeof(badCode));
+    brokenAnimationResult("looping, key frame cut short", encoded.data.data(), 40);
+
+#ifdef ST7558_ENABLE_RECORDER
+    header("frame recorder, XOR delta + RLE to a memory sink");
+    MemoryPrint sink;
+    flushResult("display() snake frame, not recording", snakeFrame);
+    lcd.startRecording(sink, recordReference);
+    flushResult("display() snake frame, recording", snakeFrame);
+    flushResult("display() full frame, recording", [](uint32_t i) {
+        lcd.fillScreen(i & 1);
+    });
+    flushResult("display() one digit, recording", [](uint32_t i) {
+        lcd.fillRect(37, 1, 6, 8, WHITE);
+        lcd.setCursor(37, 1);
+        lcd.print(i % 10);
+    });
+    lcd.stopRecording();
+    recorderResult("replay snake frames", snakeFrame, sink);
+    recorderResult("replay random rects", [](uint32_t i) {
+        srand(i);
+        for (uint8_t k = rand() % 8; k; k--) {
+            lcd.fillRect(rand() % 96, rand() % 65, rand() % 40, rand() % 30, rand() & 1);
+        }
+    }, sink);
+    recorderResult("replay score digits", [](uint32_t i) {
+        lcd.fillRect(37, 1, 6, 8, WHITE);
+        lcd.setCursor(37, 1);
+        lcd.print(i % 10);
+    }, sink);
+    lcd.setBackBuffer(frameA);
+    recorderResult("replay double buffered snake", snakeFrame, sink);
+    lcd.setBackBuffer(NULL);
+    snprintf(pbm, sizeof(pbm), "%s/recording.bin", argc > 1 ? argv[1] : ".");
+    FILE *recording = fopen(pbm, "wb");
+    if (recording) {
+        fwrite(sink.data.data(), 1, sink.data.size(), recording);
+        fclose(recording);
+        printf("  last recording saved to %s\n", pbm);
+    }
+#endif
+
+#ifdef ST7558_ENABLE_PIPELINE
+    header("3 ms app work per frame, real-time mock bus @ 400k");
+    Wire.setClock(400000);
+    Wire.setRealTime(true);
+    pipelineResults("snake", snakeFrame);
+    pipelineResults("stripes", stripesFrame);
+    Wire.setRealTime(false);
+    Wire.setClock(100000);
+#endif
+
+#ifdef ST7558_ENABLE_STATS
+    header("driver counters, 200 snake frames");
+    StdoutPrint out;
+    lcd.resetStats();
+    for (uint32_t i = 0; i < 200; i++) {
+        snakeFrame(i);
+        lcd.display();
+    }
+    lcd.printStats(out);
+#endif
+
+    return 0;
+}
+#else
+
+/**************************************************************/
+/** @brief Draw 100 frames of the mixed scene in strips, with
+           firstPage()/nextPage(), and decode the bus log with a
+           controller emulator. Reports the pixels where the
+           panel and the same scene drawn whole on a canvas of
+           the panel's size disagree
+*/
+/**************************************************************/
+static void stripResult(const char *name) {
+
+    static ST7558Canvas reference(ST7558_WIDTH, ST7558_HEIGHT);
+    const uint32_t frames = 100;
+    uint32_t differ = 0, bytes = 0, passes = 0;
+    ST7558Emulator panel;
+
+    Wire.setRecording(true);
+    Wire.reset();
+    lcd.begin();
+    panel.feed(Wire.events());
+    for (uint32_t i = 0; i < frames; i++) {
+
+        mixedScene(reference, i);
+        Wire.reset();
+        lcd.firstPage();
+        do {
+            mixedScene(lcd, i);
+            passes++;
+        } while (lcd.nextPage());
+        bytes += Wire.bytes();
+        panel.feed(Wire.events());
+        differ += panel.compare(reference.getBuffer());
+    }
+    Wire.setRecording(false);
+    printf("  %-34s %10u px differ %4u errors %6u B/frame %3u passes\n", name, differ,
+           panel.errors(), bytes / frames, passes / frames);
+}
+
+int main(void) {
+
+    char title[64];
+    Wire.setRecording(false);
+    lcd.begin();
+    ST7558::toPageMajor(snake_logo, snake_logo_w, snake_logo_h, logoPages);
+
+    snprintf(title, sizeof(title), "strip mode, %u pages per pass (host CPU, mock bus)",
+             ST7558_STRIP_PAGES);
+    header(title);
+    drawResult("mixed scene, firstPage()/nextPage()", nsPerOp(200, [](uint32_t i) {
+        lcd.firstPage();
+        do {
+            mixedScene(lcd, i);
+        } while (lcd.nextPage());
+    }));
+
+    header("controller emulator, panel vs the scene drawn whole on a canvas");
+    stripResult("mixed scene in strips");
+    return 0;
+}
+#endif
@@ -0,0 +1,177 @@
+/**
+ * @file encoder.cpp
+ *
+ * Encodes PBM images (P1 or P4, up to the panel size, drawn from the top
+ * left) into an animation for ST7558Animation: a key frame, then each
+ * frame as the XOR with the one before, run-length coded, see
+ * ST7558Delta.h. Frames equal to the one before cost nothing. Writes a C
+ * header with a PROGMEM array, or the raw stream if the output ends in
+ * .bin.
+ *
+ *   encoder [-d ms per frame] [-k key frame every n] [-n name] output frame.pbm...
+ */
+
+#include <ST7558.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <string>
+#include <vector>
+
+// Collects the stream
+class MemoryPrint : public Print {
+
+    public:
+
+        std::vector<uint8_t> data;
+
+        size_t write(uint8_t c) { data.push_back(c); return 1; }
+        size_t write(const uint8_t *buffer, size_t size) {
+            data.insert(data.end(), buffer, buffer + size);
+            return size;
+        }
+};
+
+static int pbmNumber(FILE *file) {
+
+    int c;
+    do {
+        c = fgetc(file);
+        if (c == '#') {
+            while (c != '\n' && c != EOF) {
+                c = fgetc(file);
+            }
+        }
+    } while (c == ' ' || c == '\t' || c == '\r' || c == '\n');
+    int n = -1;
+    for (; c >= '0' && c <= '9'; c = fgetc(file)) {
+        n = (n < 0 ? 0 : n * 10) + (c - '0');
+    }
+    return n;
+}
+
+/**************************************************************/
+/** @brief Read a PBM into a page-major frame, black pixels set
+    @return false if it can't be read or is larger than the panel
+*/
+/**************************************************************/
+static bool readPBM(const char *path, uint8_t *frame) {
+
+    FILE *file = fopen(path, "rb");
+    if (!file) {
+        perror(path);
+        return false;
+    }
+    char magic[2] = { 0, 0 };
+    const bool header = fread(magic, 1, 2, file) == 2 && magic[0] == 'P'
+                        && (magic[1] == '1' || magic[1] == '4');
+    const int w = header ? pbmNumber(file) : -1;
+    const int h = header ? pbmNumber(file) : -1;
+    if (w <= 0 || h <= 0 || w > ST7558_WIDTH || h > ST7558_HEIGHT) {
+        fprintf(stderr, "%s: not a PBM of up to %ux%u\n", path, ST7558_WIDTH, ST7558_HEIGHT);
+        fclose(file);
+        return false;
+    }
+    memset(frame, 0, ST7558_BUFFER_SIZE);
+    bool ok = true;
+    for (int y = 0; y < h && ok; y++) {
+
+        int bits = 0;
+        for (int x = 0; x < w && ok; x++) {
+
+            int bit;
+            if (magic[1] == '4') {
+                if (x % 8 == 0) {
+                    bits = fgetc(file);
+                }
+                ok = bits != EOF;
+                bit = (bits >> (7 - x % 8)) & 1;
+            } else {
+                bit = pbmNumber(file);
+                ok = bit == 0 || bit == 1;
+            }
+            if (ok && bit) {
+                frame[(y / 8) * ST7558_WIDTH + x] |= 1 << (y % 8);
+            }
+        }
+    }
+    fclose(file);
+    if (!ok) {
+        fprintf(stderr, "%s: cut short\n", path);
+    }
+    return ok;
+}
+
+static void usage(const char *name) {
+
+    fprintf(stderr, "usage: %s [-d ms per frame] [-k key frame every n frames] "
+                    "[-n array name] output.h|output.bin frame.pbm...\n", name);
+}
+
+int main(int argc, char **argv) {
+
+    unsigned delay = 100, keys = 0;
+    std::string name = "animation";
+    int opt;
+    while ((opt = getopt(argc, argv, "d:k:n:")) != -1) {
+        switch (opt) {
+            case 'd': delay = atoi(optarg); break;
+            case 'k': keys = atoi(optarg); break;
+            case 'n': name = optarg; break;
+            default: usage(argv[0]); return 2;
+        }
+    }
+    if (argc - optind < 2) {
+        usage(argv[0]);
+        return 2;
+    }
+    const char *output = argv[optind];
+    const int frames = argc - optind - 1;
+
+    MemoryPrint sink;
+    uint8_t frame[ST7558_BUFFER_SIZE];
+    uint8_t reference[ST7558_BUFFER_SIZE];
+    ST7558DeltaWriter::header(sink, ST7558_WIDTH, ST7558_HEIGHT);
+    for (int i = 0; i < frames; i++) {
+
+        if (!readPBM(argv[optind + 1 + i], frame)) {
+            return 1;
+        }
+        const bool key = i == 0 || (keys && i % keys == 0);
+        if (key) {
+            memset(reference, 0, sizeof(reference));
+        }
+        ST7558DeltaWriter out(sink, key ? ST7558_REC_KEY : ST7558_REC_FRAME, i, i * delay);
+        out.code(frame, false, reference, 0, ST7558_BUFFER_SIZE - 1);
+        out.finish(key);
+    }
+    // an empty record at the end times the last frame
+    ST7558DeltaWriter end(sink, ST7558_REC_FRAME, frames, frames * delay);
+    end.finish(true);
+
+    FILE *file = fopen(output, "wb");
+    if (!file) {
+        perror(output);
+        return 1;
+    }
+    const size_t length = strlen(output);
+    if (length > 4 && strcmp(output + length - 4, ".bin") == 0) {
+        fwrite(sink.data.data(), 1, sink.data.size(), file);
+    } else {
+        fprintf(file, "// %s: %d frames of %ux%u, %u ms each, made by extras/host/encoder\n",
+                name.c_str(), frames, ST7558_WIDTH, ST7558_HEIGHT, delay);
+        fprintf(file, "const uint8_t %s[] PROGMEM = {", name.c_str());
+        for (size_t i = 0; i < sink.data.size(); i++) {
+            fprintf(file, "%s0x%02X%s", (i % 12) ? " " : "\n    ", sink.data[i],
+                    (i + 1 < sink.data.size()) ? "," : "\n");
+        }
+        fprintf(file, "};\n");
+    }
+    if (fclose(file) != 0) {
+        perror(output);
+        return 1;
+    }
+    printf("%d frames, %zu bytes, %u raw\n", frames, sink.data.size(),
+           (unsigned)(frames * ST7558_BUFFER_SIZE));
+    return 0;
+}
@@ -0,0 +1,54 @@
+/**
+ * @file player.cpp
+ *
+ * Replays a recording made with ST7558::startRecording(): prints one line
+ * per frame and saves each frame as a PBM image.
+ *
+ *   player recording.bin [output directory]
+ */
+
+#include "ST7558Player.h"
+#include <stdio.h>
+#include <vector>
+
+int main(int argc, char **argv) {
+
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s recording.bin [output directory]\n", argv[0]);
+        return 2;
+    }
+    FILE *file = fopen(argv[1], "rb");
+    if (!file) {
+        perror(argv[1]);
+        return 1;
+    }
+    std::vector<uint8_t> data;
+    uint8_t chunk[4096];
+    size_t n;
+    while ((n = fread(chunk, 1, sizeof(chunk), file)) > 0) {
+        data.insert(data.end(), chunk, chunk + n);
+    }
+    fclose(file);
+
+    ST7558Player player(data.data(), data.size());
+    if (!player.valid()) {
+        fprintf(stderr, "%s: not an ST7558 recording\n", argv[1]);
+        return 1;
+    }
+    printf("%ux%u, %zu bytes\n", player.width(), player.height(), data.size());
+    while (player.next()) {
+
+        char path[256];
+        snprintf(path, sizeof(path), "%s/frame-%05u.pbm", argc > 2 ? argv[2] : ".",
+                 (unsigned)player.frames());
+        printf("  frame %5u  #%u at %lu ms\n", (unsigned)player.frames(), player.index(),
+               (unsigned long)player.millis());
+        if (!player.writePBM(path)) {
+            fprintf(stderr, "can't write %s\n", path);
+            return 1;
+        }
+    }
+    printf("%lu frames, %lu errors\n", (unsigned long)player.frames(),
+           (unsigned long)player.errors());
+    return player.errors() ? 1 : 0;
+}
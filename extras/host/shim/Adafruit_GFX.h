@@ -0,0 +1,93 @@
+/**
+ * @file Adafruit_GFX.h
+ *
+ * Reduced Adafruit_GFX for the Linux host build. The class layout, virtual
+ * hooks and default algorithms follow upstream so the ST7558 overrides are
+ * exercised the same way they are on a board.
+ */
+
+#ifndef _ADAFRUIT_GFX_H
+#define _ADAFRUIT_GFX_H
+
+#include "Arduino.h"
+#include "gfxfont.h"
+
+class Adafruit_GFX : public Print {
+
+    public:
+
+        Adafruit_GFX(int16_t w, int16_t h);
+        virtual ~Adafruit_GFX() {}
+
+        virtual void drawPixel(int16_t x, int16_t y, uint16_t color) = 0;
+
+        virtual void startWrite(void);
+        virtual void writePixel(int16_t x, int16_t y, uint16_t color);
+        virtual void writeFillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+        virtual void writeFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color);
+        virtual void writeFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color);
+        virtual void writeLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color);
+        virtual void endWrite(void);
+
+        virtual void setRotation(uint8_t r);
+        virtual void invertDisplay(bool i);
+
+        virtual void drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color);
+        virtual void drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color);
+        virtual void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+        virtual void fillScreen(uint16_t color);
+        virtual void drawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color);
+        virtual void drawRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+
+        void drawCircle(int16_t x0, int16_t y0, int16_t r, uint16_t color);
+        void drawCircleHelper(int16_t x0, int16_t y0, int16_t r, uint8_t cornername, uint16_t color);
+        void fillCircle(int16_t x0, int16_t y0, int16_t r, uint16_t color);
+        void fillCircleHelper(int16_t x0, int16_t y0, int16_t r, uint8_t corners, int16_t delta, uint16_t color);
+        void drawTriangle(int16_t x0, int16_t y0, int16_t x1, int16_t y1, int16_t x2, int16_t y2, uint16_t color);
+        void fillTriangle(int16_t x0, int16_t y0, int16_t x1, int16_t y1, int16_t x2, int16_t y2, uint16_t color);
+        void drawRoundRect(int16_t x0, int16_t y0, int16_t w, int16_t h, int16_t radius, uint16_t color);
+        void fillRoundRect(int16_t x0, int16_t y0, int16_t w, int16_t h, int16_t radius, uint16_t color);
+        void drawBitmap(int16_t x, int16_t y, const uint8_t bitmap[], int16_t w, int16_t h, uint16_t color);
+        void drawBitmap(int16_t x, int16_t y, const uint8_t bitmap[], int16_t w, int16_t h, uint16_t color, uint16_t bg);
+        void drawBitmap(int16_t x, int16_t y, uint8_t *bitmap, int16_t w, int16_t h, uint16_t color);
+        void drawBitmap(int16_t x, int16_t y, uint8_t *bitmap, int16_t w, int16_t h, uint16_t color, uint16_t bg);
+
+        virtual void drawChar(int16_t x, int16_t y, unsigned char c, uint16_t color, uint16_t bg, uint8_t size);
+        virtual void drawChar(int16_t x, int16_t y, unsigned char c, uint16_t color, uint16_t bg, uint8_t size_x, uint8_t size_y);
+        void setTextSize(uint8_t s);
+        void setTextSize(uint8_t sx, uint8_t sy);
+        void setFont(const GFXfont *f = NULL);
+        void setCursor(int16_t x, int16_t y) { cursor_x = x; cursor_y = y; }
+        void setTextColor(uint16_t c) { textcolor = textbgcolor = c; }
+        void setTextColor(uint16_t c, uint16_t bg) { textcolor = c; textbgcolor = bg; }
+        void setTextWrap(bool w) { wrap = w; }
+        void cp437(bool x = true) { _cp437 = x; }
+
+        using Print::write;
+        virtual size_t write(uint8_t c);
+
+        int16_t width(void) const { return _width; }
+        int16_t height(void) const { return _height; }
+        uint8_t getRotation(void) const { return rotation; }
+        int16_t getCursorX(void) const { return cursor_x; }
+        int16_t getCursorY(void) const { return cursor_y; }
+
+    protected:
+
+        int16_t WIDTH;
+        int16_t HEIGHT;
+        int16_t _width;
+        int16_t _height;
+        int16_t cursor_x;
+        int16_t cursor_y;
+        uint16_t textcolor;
+        uint16_t textbgcolor;
+        uint8_t textsize_x;
+        uint8_t textsize_y;
+        uint8_t rotation;
+        bool wrap;
+        bool _cp437;
+        GFXfont *gfxFont;
+};
+
+#endif
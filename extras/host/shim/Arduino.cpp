@@ -0,0 +1,27 @@
+/**
+ * @file Arduino.cpp
+ *
+ * Host implementations of the Arduino timing and GPIO calls. GPIO is a no-op,
+ * time comes from the monotonic clock.
+ */
+
+#include "Arduino.h"
+#include <time.h>
+#include <unistd.h>
+
+static uint64_t _nowMicros(void) {
+
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000;
+}
+
+static const uint64_t _startMicros = _nowMicros();
+
+uint32_t millis(void) { return (uint32_t)((_nowMicros() - _startMicros) / 1000); }
+uint32_t micros(void) { return (uint32_t)(_nowMicros() - _startMicros); }
+void delay(uint32_t ms) { usleep(ms * 1000); }
+void delayMicroseconds(uint32_t us) { usleep(us); }
+void pinMode(uint8_t, uint8_t) {}
+void digitalWrite(uint8_t, uint8_t) {}
+int digitalRead(uint8_t) { return HIGH; }
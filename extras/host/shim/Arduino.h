@@ -0,0 +1,56 @@
+/**
+ * @file Arduino.h
+ *
+ * Minimal Arduino core shim for building the ST7558 driver on a Linux host.
+ * Only the pieces the driver, Adafruit_GFX shim and benchmarks use are here.
+ */
+
+#ifndef ST7558_HOST_ARDUINO_H
+#define ST7558_HOST_ARDUINO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "Print.h"
+#include "Stream.h"
+
+#define HIGH    0x1
+#define LOW     0x0
+
+#define INPUT   0x0
+#define OUTPUT  0x1
+
+#define DEC     10
+#define HEX     16
+#define OCT     8
+#define BIN     2
+
+#define A0      14
+#define A1      15
+#define A2      16
+#define A3      17
+
+#define PROGMEM
+#define PSTR(s)                 (s)
+#define F(s)                    (reinterpret_cast<const __FlashStringHelper *>(s))
+#define pgm_read_byte(addr)     (*(const uint8_t *)(addr))
+#define pgm_read_word(addr)     (*(const uint16_t *)(addr))
+#define pgm_read_dword(addr)    (*(const uint32_t *)(addr))
+#define pgm_read_pointer(addr)  (*(void * const *)(addr))
+#define memcpy_P                memcpy
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+uint32_t millis(void);
+uint32_t micros(void);
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t val);
+int digitalRead(uint8_t pin);
+
+#endif
@@ -0,0 +1 @@
+/* Empty SPI shim: the driver includes <SPI.h> only for Adafruit_GFX. */
@@ -0,0 +1,21 @@
+/**
+ * @file Stream.h
+ *
+ * Minimal Stream class shim for the Linux host build.
+ */
+
+#ifndef ST7558_HOST_STREAM_H
+#define ST7558_HOST_STREAM_H
+
+#include "Print.h"
+
+class Stream : public Print {
+
+    public:
+
+        virtual int available(void) = 0;
+        virtual int read(void) = 0;         // -1 if nothing is available
+        virtual int peek(void) = 0;
+};
+
+#endif
@@ -0,0 +1,98 @@
+/**
+ * @file Wire.cpp
+ *
+ * Mock TwoWire implementation. Bytes are buffered like the real cores do
+ * (writes beyond the buffer are dropped and counted) and the whole
+ * transaction is logged at endTransmission().
+ */
+
+#include "Wire.h"
+#include <unistd.h>
+
+TwoWire Wire;
+
+TwoWire::TwoWire(void) :
+    _bufferSize(BUFFER_LENGTH), _clock(100000), _maxClock(0xFFFFFFFF), _address(0),
+    _recording(true), _realTime(false), _transactions(0), _bytes(0), _overflows(0) {}
+
+void TwoWire::begin(void) {}
+
+void TwoWire::setClock(uint32_t clock) { _clock = clock; }
+
+void TwoWire::beginTransmission(uint8_t address) {
+
+    _address = address;
+    _pending.clear();
+}
+
+size_t TwoWire::write(uint8_t data) {
+
+    if (_pending.size() >= _bufferSize) {
+        _overflows++;
+        return 0;
+    }
+    _pending.push_back(data);
+    return 1;
+}
+
+size_t TwoWire::write(const uint8_t *data, size_t n) {
+
+    size_t written = 0;
+    while (n--) {
+        written += write(*data++);
+    }
+    return written;
+}
+
+uint8_t TwoWire::endTransmission(bool sendStop) {
+
+    _transactions++;
+    _bytes += _pending.size();
+    if (_realTime) {
+        usleep((1 + 9 + 1 + _pending.size() * 9) * 1000000ULL / _clock);
+    }
+    if (_recording) {
+        _events.push_back({Event::START, 0});
+        _events.push_back({Event::ADDRESS, (uint8_t)(_address << 1)});
+        for (uint8_t b : _pending) {
+            _events.push_back({Event::BYTE, b});
+        }
+        if (sendStop) {
+            _events.push_back({Event::STOP, 0});
+        }
+    }
+    _pending.clear();
+    return (_clock > _maxClock) ? 2 : 0;    // 2: address NACK
+}
+
+void TwoWire::setBufferSize(size_t size) { _bufferSize = size; }
+size_t TwoWire::bufferSize(void) const { return _bufferSize; }
+void TwoWire::setMaxClock(uint32_t clock) { _maxClock = clock; }
+void TwoWire::setRealTime(bool state) { _realTime = state; }
+void TwoWire::setRecording(bool state) { _recording = state; }
+uint32_t TwoWire::clock(void) const { return _clock; }
+const std::vector<TwoWire::Event> &TwoWire::events(void) const { return _events; }
+uint32_t TwoWire::transactions(void) const { return _transactions; }
+uint32_t TwoWire::bytes(void) const { return _bytes; }
+uint32_t TwoWire::overflows(void) const { return _overflows; }
+
+void TwoWire::reset(void) {
+
+    _events.clear();
+    _transactions = 0;
+    _bytes = 0;
+    _overflows = 0;
+}
+
+/**************************************************************/
+/** @brief Bit times on the wire: one per START and STOP, nine
+           (8 data + ACK) per address and payload byte.
+*/
+/**************************************************************/
+uint64_t TwoWire::bits(void) const {
+    return (uint64_t)_transactions * (1 + 9 + 1) + (uint64_t)_bytes * 9;
+}
+
+double TwoWire::busMicros(uint32_t clock) const {
+    return bits() * 1e6 / clock;
+}
@@ -0,0 +1,69 @@
+/**
+ * @file Wire.h
+ *
+ * Mock TwoWire for the Linux host build. Every START, address byte, data
+ * byte and STOP is recorded so tests and benchmarks can inspect exactly what
+ * the driver put on the bus and model how long it would take.
+ */
+
+#ifndef ST7558_HOST_WIRE_H
+#define ST7558_HOST_WIRE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+
+#define BUFFER_LENGTH 32
+
+class TwoWire {
+
+    public:
+
+        struct Event {
+
+            enum Kind : uint8_t { START, ADDRESS, BYTE, STOP } kind;
+            uint8_t value;
+        };
+
+        TwoWire(void);
+
+        void begin(void);
+        void setClock(uint32_t clock);
+        void beginTransmission(uint8_t address);
+        size_t write(uint8_t data);
+        size_t write(const uint8_t *data, size_t n);
+        uint8_t endTransmission(bool sendStop = true);
+
+        // mock only
+        void setBufferSize(size_t size);
+        size_t bufferSize(void) const;
+        void setMaxClock(uint32_t clock);       // NACK every transaction above it
+        void setRealTime(bool state);           // sleep for each transaction's bus time
+        void setRecording(bool state);
+        void reset(void);
+        uint32_t clock(void) const;
+        const std::vector<Event> &events(void) const;
+        uint32_t transactions(void) const;
+        uint32_t bytes(void) const;
+        uint32_t overflows(void) const;
+        uint64_t bits(void) const;
+        double busMicros(uint32_t clock) const;
+
+    private:
+
+        std::vector<uint8_t> _pending;
+        std::vector<Event> _events;
+        size_t _bufferSize;
+        uint32_t _clock;
+        uint32_t _maxClock;
+        uint8_t _address;
+        bool _recording;
+        bool _realTime;
+        uint32_t _transactions;
+        uint32_t _bytes;
+        uint32_t _overflows;
+};
+
+extern TwoWire Wire;
+
+#endif
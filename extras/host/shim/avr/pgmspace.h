@@ -0,0 +1,2 @@
+/* Host shim: PROGMEM helpers live in Arduino.h. */
+#include "../Arduino.h"
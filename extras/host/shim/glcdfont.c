@@ -0,0 +1,139 @@
+// Placeholder glyph table for the host shim. Same layout as upstream
+// glcdfont.c (256 glyphs x 5 column bytes, LSB = top row); the glyph
+// shapes are generated and not meant to be legible.
+
+#ifndef FONT5X7_H
+#define FONT5X7_H
+
+static const unsigned char font[] PROGMEM = {
+    0x00, 0x5B, 0x36, 0x11, 0x6C, 0x25, 0x00, 0x5B, 0x36, 0x11,
+    0x4A, 0x25, 0x00, 0x5B, 0x36, 0x6F, 0x4A, 0x25, 0x00, 0x5B,
+    0x14, 0x6F, 0x4A, 0x25, 0x00, 0x39, 0x14, 0x6F, 0x4A, 0x25,
+    0x5E, 0x39, 0x14, 0x6F, 0x4A, 0x03, 0x5E, 0x39, 0x14, 0x6F,
+    0x35, 0x10, 0x6B, 0x46, 0x21, 0x5A, 0x35, 0x10, 0x6B, 0x46,
+    0x7F, 0x5A, 0x35, 0x10, 0x6B, 0x24, 0x7F, 0x5A, 0x35, 0x10,
+    0x49, 0x24, 0x7F, 0x5A, 0x35, 0x6E, 0x49, 0x24, 0x7F, 0x5A,
+    0x13, 0x6E, 0x49, 0x24, 0x7F, 0x38, 0x13, 0x6E, 0x49, 0x24,
+    0x6A, 0x45, 0x20, 0x7B, 0x56, 0x0F, 0x6A, 0x45, 0x20, 0x7B,
+    0x34, 0x0F, 0x6A, 0x45, 0x20, 0x59, 0x34, 0x0F, 0x6A, 0x45,
+    0x7E, 0x59, 0x34, 0x0F, 0x6A, 0x23, 0x7E, 0x59, 0x34, 0x0F,
+    0x48, 0x23, 0x7E, 0x59, 0x34, 0x6D, 0x48, 0x23, 0x7E, 0x59,
+    0x1F, 0x7A, 0x55, 0x30, 0x0B, 0x44, 0x1F, 0x7A, 0x55, 0x30,
+    0x69, 0x44, 0x1F, 0x7A, 0x55, 0x0E, 0x69, 0x44, 0x1F, 0x7A,
+    0x33, 0x0E, 0x69, 0x44, 0x1F, 0x58, 0x33, 0x0E, 0x69, 0x44,
+    0x7D, 0x58, 0x33, 0x0E, 0x69, 0x22, 0x7D, 0x58, 0x33, 0x0E,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x79, 0x54, 0x2F, 0x0A, 0x65,
+    0x1E, 0x79, 0x54, 0x2F, 0x0A, 0x43, 0x1E, 0x79, 0x54, 0x2F,
+    0x68, 0x43, 0x1E, 0x79, 0x54, 0x0D, 0x68, 0x43, 0x1E, 0x79,
+    0x32, 0x0D, 0x68, 0x43, 0x1E, 0x57, 0x32, 0x0D, 0x68, 0x43,
+    0x09, 0x64, 0x3F, 0x1A, 0x75, 0x2E, 0x09, 0x64, 0x3F, 0x1A,
+    0x53, 0x2E, 0x09, 0x64, 0x3F, 0x78, 0x53, 0x2E, 0x09, 0x64,
+    0x1D, 0x78, 0x53, 0x2E, 0x09, 0x42, 0x1D, 0x78, 0x53, 0x2E,
+    0x67, 0x42, 0x1D, 0x78, 0x53, 0x0C, 0x67, 0x42, 0x1D, 0x78,
+    0x3E, 0x19, 0x74, 0x4F, 0x2A, 0x63, 0x3E, 0x19, 0x74, 0x4F,
+    0x08, 0x63, 0x3E, 0x19, 0x74, 0x2D, 0x08, 0x63, 0x3E, 0x19,
+    0x52, 0x2D, 0x08, 0x63, 0x3E, 0x77, 0x52, 0x2D, 0x08, 0x63,
+    0x1C, 0x77, 0x52, 0x2D, 0x08, 0x41, 0x1C, 0x77, 0x52, 0x2D,
+    0x73, 0x4E, 0x29, 0x04, 0x5F, 0x18, 0x73, 0x4E, 0x29, 0x04,
+    0x3D, 0x18, 0x73, 0x4E, 0x29, 0x62, 0x3D, 0x18, 0x73, 0x4E,
+    0x07, 0x62, 0x3D, 0x18, 0x73, 0x2C, 0x07, 0x62, 0x3D, 0x18,
+    0x51, 0x2C, 0x07, 0x62, 0x3D, 0x76, 0x51, 0x2C, 0x07, 0x62,
+    0x28, 0x03, 0x5E, 0x39, 0x14, 0x4D, 0x28, 0x03, 0x5E, 0x39,
+    0x72, 0x4D, 0x28, 0x03, 0x5E, 0x17, 0x72, 0x4D, 0x28, 0x03,
+    0x3C, 0x17, 0x72, 0x4D, 0x28, 0x61, 0x3C, 0x17, 0x72, 0x4D,
+    0x06, 0x61, 0x3C, 0x17, 0x72, 0x2B, 0x06, 0x61, 0x3C, 0x17,
+    0x5D, 0x38, 0x13, 0x6E, 0x49, 0x02, 0x5D, 0x38, 0x13, 0x6E,
+    0x27, 0x02, 0x5D, 0x38, 0x13, 0x4C, 0x27, 0x02, 0x5D, 0x38,
+    0x71, 0x4C, 0x27, 0x02, 0x5D, 0x16, 0x71, 0x4C, 0x27, 0x02,
+    0x3B, 0x16, 0x71, 0x4C, 0x27, 0x60, 0x3B, 0x16, 0x71, 0x4C,
+    0x12, 0x6D, 0x48, 0x23, 0x7E, 0x37, 0x12, 0x6D, 0x48, 0x23,
+    0x5C, 0x37, 0x12, 0x6D, 0x48, 0x01, 0x5C, 0x37, 0x12, 0x6D,
+    0x26, 0x01, 0x5C, 0x37, 0x12, 0x4B, 0x26, 0x01, 0x5C, 0x37,
+    0x70, 0x4B, 0x26, 0x01, 0x5C, 0x15, 0x70, 0x4B, 0x26, 0x01,
+    0x47, 0x22, 0x7D, 0x58, 0x33, 0x6C, 0x47, 0x22, 0x7D, 0x58,
+    0x11, 0x6C, 0x47, 0x22, 0x7D, 0x36, 0x11, 0x6C, 0x47, 0x22,
+    0x5B, 0x36, 0x11, 0x6C, 0x47, 0x00, 0x5B, 0x36, 0x11, 0x6C,
+    0x25, 0x00, 0x5B, 0x36, 0x11, 0x4A, 0x25, 0x00, 0x5B, 0x36,
+    0x7C, 0x57, 0x32, 0x0D, 0x68, 0x21, 0x7C, 0x57, 0x32, 0x0D,
+    0x46, 0x21, 0x7C, 0x57, 0x32, 0x6B, 0x46, 0x21, 0x7C, 0x57,
+    0x10, 0x6B, 0x46, 0x21, 0x7C, 0x35, 0x10, 0x6B, 0x46, 0x21,
+    0x5A, 0x35, 0x10, 0x6B, 0x46, 0x7F, 0x5A, 0x35, 0x10, 0x6B,
+    0x31, 0x0C, 0x67, 0x42, 0x1D, 0x56, 0x31, 0x0C, 0x67, 0x42,
+    0x7B, 0x56, 0x31, 0x0C, 0x67, 0x20, 0x7B, 0x56, 0x31, 0x0C,
+    0x45, 0x20, 0x7B, 0x56, 0x31, 0x6A, 0x45, 0x20, 0x7B, 0x56,
+    0x0F, 0x6A, 0x45, 0x20, 0x7B, 0x34, 0x0F, 0x6A, 0x45, 0x20,
+    0x66, 0x41, 0x1C, 0x77, 0x52, 0x0B, 0x66, 0x41, 0x1C, 0x77,
+    0x30, 0x0B, 0x66, 0x41, 0x1C, 0x55, 0x30, 0x0B, 0x66, 0x41,
+    0x7A, 0x55, 0x30, 0x0B, 0x66, 0x1F, 0x7A, 0x55, 0x30, 0x0B,
+    0x44, 0x1F, 0x7A, 0x55, 0x30, 0x69, 0x44, 0x1F, 0x7A, 0x55,
+    0x1B, 0x76, 0x51, 0x2C, 0x07, 0x40, 0x1B, 0x76, 0x51, 0x2C,
+    0x65, 0x40, 0x1B, 0x76, 0x51, 0x0A, 0x65, 0x40, 0x1B, 0x76,
+    0x2F, 0x0A, 0x65, 0x40, 0x1B, 0x54, 0x2F, 0x0A, 0x65, 0x40,
+    0x79, 0x54, 0x2F, 0x0A, 0x65, 0x1E, 0x79, 0x54, 0x2F, 0x0A,
+    0x50, 0x2B, 0x06, 0x61, 0x3C, 0x75, 0x50, 0x2B, 0x06, 0x61,
+    0x1A, 0x75, 0x50, 0x2B, 0x06, 0x3F, 0x1A, 0x75, 0x50, 0x2B,
+    0x64, 0x3F, 0x1A, 0x75, 0x50, 0x09, 0x64, 0x3F, 0x1A, 0x75,
+    0x2E, 0x09, 0x64, 0x3F, 0x1A, 0x53, 0x2E, 0x09, 0x64, 0x3F,
+    0x05, 0x60, 0x3B, 0x16, 0x71, 0x2A, 0x05, 0x60, 0x3B, 0x16,
+    0x4F, 0x2A, 0x05, 0x60, 0x3B, 0x74, 0x4F, 0x2A, 0x05, 0x60,
+    0x19, 0x74, 0x4F, 0x2A, 0x05, 0x3E, 0x19, 0x74, 0x4F, 0x2A,
+    0x63, 0x3E, 0x19, 0x74, 0x4F, 0x08, 0x63, 0x3E, 0x19, 0x74,
+    0x3A, 0x15, 0x70, 0x4B, 0x26, 0x5F, 0x3A, 0x15, 0x70, 0x4B,
+    0x04, 0x5F, 0x3A, 0x15, 0x70, 0x29, 0x04, 0x5F, 0x3A, 0x15,
+    0x4E, 0x29, 0x04, 0x5F, 0x3A, 0x73, 0x4E, 0x29, 0x04, 0x5F,
+    0x18, 0x73, 0x4E, 0x29, 0x04, 0x3D, 0x18, 0x73, 0x4E, 0x29,
+    0x6F, 0x4A, 0x25, 0x00, 0x5B, 0x14, 0x6F, 0x4A, 0x25, 0x00,
+    0x39, 0x14, 0x6F, 0x4A, 0x25, 0x5E, 0x39, 0x14, 0x6F, 0x4A,
+    0x03, 0x5E, 0x39, 0x14, 0x6F, 0x28, 0x03, 0x5E, 0x39, 0x14,
+    0x4D, 0x28, 0x03, 0x5E, 0x39, 0x72, 0x4D, 0x28, 0x03, 0x5E,
+    0x24, 0x7F, 0x5A, 0x35, 0x10, 0x49, 0x24, 0x7F, 0x5A, 0x35,
+    0x6E, 0x49, 0x24, 0x7F, 0x5A, 0x13, 0x6E, 0x49, 0x24, 0x7F,
+    0x38, 0x13, 0x6E, 0x49, 0x24, 0x5D, 0x38, 0x13, 0x6E, 0x49,
+    0x02, 0x5D, 0x38, 0x13, 0x6E, 0x27, 0x02, 0x5D, 0x38, 0x13,
+    0x59, 0x34, 0x0F, 0x6A, 0x45, 0x7E, 0x59, 0x34, 0x0F, 0x6A,
+    0x23, 0x7E, 0x59, 0x34, 0x0F, 0x48, 0x23, 0x7E, 0x59, 0x34,
+    0x6D, 0x48, 0x23, 0x7E, 0x59, 0x12, 0x6D, 0x48, 0x23, 0x7E,
+    0x37, 0x12, 0x6D, 0x48, 0x23, 0x5C, 0x37, 0x12, 0x6D, 0x48,
+    0x0E, 0x69, 0x44, 0x1F, 0x7A, 0x33, 0x0E, 0x69, 0x44, 0x1F,
+    0x58, 0x33, 0x0E, 0x69, 0x44, 0x7D, 0x58, 0x33, 0x0E, 0x69,
+    0x22, 0x7D, 0x58, 0x33, 0x0E, 0x47, 0x22, 0x7D, 0x58, 0x33,
+    0x6C, 0x47, 0x22, 0x7D, 0x58, 0x11, 0x6C, 0x47, 0x22, 0x7D,
+    0x43, 0x1E, 0x79, 0x54, 0x2F, 0x68, 0x43, 0x1E, 0x79, 0x54,
+    0x0D, 0x68, 0x43, 0x1E, 0x79, 0x32, 0x0D, 0x68, 0x43, 0x1E,
+    0x57, 0x32, 0x0D, 0x68, 0x43, 0x7C, 0x57, 0x32, 0x0D, 0x68,
+    0x21, 0x7C, 0x57, 0x32, 0x0D, 0x46, 0x21, 0x7C, 0x57, 0x32,
+    0x78, 0x53, 0x2E, 0x09, 0x64, 0x1D, 0x78, 0x53, 0x2E, 0x09,
+    0x42, 0x1D, 0x78, 0x53, 0x2E, 0x67, 0x42, 0x1D, 0x78, 0x53,
+    0x0C, 0x67, 0x42, 0x1D, 0x78, 0x31, 0x0C, 0x67, 0x42, 0x1D,
+    0x56, 0x31, 0x0C, 0x67, 0x42, 0x7B, 0x56, 0x31, 0x0C, 0x67,
+    0x2D, 0x08, 0x63, 0x3E, 0x19, 0x52, 0x2D, 0x08, 0x63, 0x3E,
+    0x77, 0x52, 0x2D, 0x08, 0x63, 0x1C, 0x77, 0x52, 0x2D, 0x08,
+    0x41, 0x1C, 0x77, 0x52, 0x2D, 0x66, 0x41, 0x1C, 0x77, 0x52,
+    0x0B, 0x66, 0x41, 0x1C, 0x77, 0x30, 0x0B, 0x66, 0x41, 0x1C,
+    0x62, 0x3D, 0x18, 0x73, 0x4E, 0x07, 0x62, 0x3D, 0x18, 0x73,
+    0x2C, 0x07, 0x62, 0x3D, 0x18, 0x51, 0x2C, 0x07, 0x62, 0x3D,
+    0x76, 0x51, 0x2C, 0x07, 0x62, 0x1B, 0x76, 0x51, 0x2C, 0x07,
+    0x40, 0x1B, 0x76, 0x51, 0x2C, 0x65, 0x40, 0x1B, 0x76, 0x51,
+    0x17, 0x72, 0x4D, 0x28, 0x03, 0x3C, 0x17, 0x72, 0x4D, 0x28,
+    0x61, 0x3C, 0x17, 0x72, 0x4D, 0x06, 0x61, 0x3C, 0x17, 0x72,
+    0x2B, 0x06, 0x61, 0x3C, 0x17, 0x50, 0x2B, 0x06, 0x61, 0x3C,
+    0x75, 0x50, 0x2B, 0x06, 0x61, 0x1A, 0x75, 0x50, 0x2B, 0x06,
+    0x4C, 0x27, 0x02, 0x5D, 0x38, 0x71, 0x4C, 0x27, 0x02, 0x5D,
+    0x16, 0x71, 0x4C, 0x27, 0x02, 0x3B, 0x16, 0x71, 0x4C, 0x27,
+    0x60, 0x3B, 0x16, 0x71, 0x4C, 0x05, 0x60, 0x3B, 0x16, 0x71,
+    0x2A, 0x05, 0x60, 0x3B, 0x16, 0x4F, 0x2A, 0x05, 0x60, 0x3B,
+    0x01, 0x5C, 0x37, 0x12, 0x6D, 0x26, 0x01, 0x5C, 0x37, 0x12,
+    0x4B, 0x26, 0x01, 0x5C, 0x37, 0x70, 0x4B, 0x26, 0x01, 0x5C,
+    0x15, 0x70, 0x4B, 0x26, 0x01, 0x3A, 0x15, 0x70, 0x4B, 0x26,
+    0x5F, 0x3A, 0x15, 0x70, 0x4B, 0x04, 0x5F, 0x3A, 0x15, 0x70,
+    0x36, 0x11, 0x6C, 0x47, 0x22, 0x5B, 0x36, 0x11, 0x6C, 0x47,
+    0x00, 0x5B, 0x36, 0x11, 0x6C, 0x25, 0x00, 0x5B, 0x36, 0x11,
+    0x4A, 0x25, 0x00, 0x5B, 0x36, 0x6F, 0x4A, 0x25, 0x00, 0x5B,
+    0x14, 0x6F, 0x4A, 0x25, 0x00, 0x39, 0x14, 0x6F, 0x4A, 0x25,
+    0x6B, 0x46, 0x21, 0x7C, 0x57, 0x10, 0x6B, 0x46, 0x21, 0x7C,
+    0x35, 0x10, 0x6B, 0x46, 0x21, 0x5A, 0x35, 0x10, 0x6B, 0x46,
+    0x7F, 0x5A, 0x35, 0x10, 0x6B, 0x24, 0x7F, 0x5A, 0x35, 0x10,
+    0x49, 0x24, 0x7F, 0x5A, 0x35, 0x6E, 0x49, 0x24, 0x7F, 0x5A,
+};
+
+#endif
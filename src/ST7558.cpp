@@ -40,24 +40,71 @@
  */
 
 #include "ST7558.h"
-#include <Wire.h>
+#include "ST7558Canvas.h"
 #include <SPI.h>  // just for adafruit gfx lib, don't pay attention
 #ifdef __AVR__
 #include <avr/pgmspace.h>
 #elif defined(ESP8266) || defined(ESP32)
 #include <pgmspace.h>
 #endif
+#ifndef ST7558_NO_GLCDFONT
+#include "glcdfont.c"   // Adafruit_GFX's classic font, its copy there is static
+#endif
+
+#ifndef pgm_read_pointer
+#if !defined(__INT_MAX__) || (__INT_MAX__ > 0xFFFF)
+#define pgm_read_pointer(addr) ((void *)pgm_read_dword(addr))
+#else
+#define pgm_read_pointer(addr) ((void *)pgm_read_word(addr))
+#endif
+#endif
+
+// Drawing is clipped to the pages held in RAM: the whole panel, or in 
+// strip mode the strip being drawn, whose first page is _buffer[0]
+#ifdef ST7558_STRIP_PAGES
+    #define ST7558_CLIP_FIRST   _stripFirst
+    #define ST7558_CLIP_LAST    _stripLast
+#else
+    #define ST7558_CLIP_FIRST   0
+    #define ST7558_CLIP_LAST    (ST7558_PAGES - 1)
+#endif
+#define ST7558_CLIP_TOP     (ST7558_CLIP_FIRST * 8)
+#define ST7558_CLIP_BOTTOM  (ST7558_CLIP_LAST == ST7558_PAGES - 1 ? ST7558_HEIGHT : (ST7558_CLIP_LAST + 1) * 8)
+
+// flush task handoff states, see _pipeState
+#define ST7558_PIPE_IDLE    0               // slot free, the app may fill it
+#define ST7558_PIPE_FRAME   1               // snapshot published, the task sends it
+#define ST7558_PIPE_STOP    2               // the task should exit
+#define ST7558_PIPE_DONE    3               // the task has exited (ESP32)
+
+#ifndef ST7558_NO_GLCDFONT
+/**************************************************************/
+/** @brief Get the column bytes of a classic font glyph, plus 
+           the spacing column: 6 bytes. One copy of the font 
+           serves ST7558 and ST7558Canvas
+*/
+/**************************************************************/
+void ST7558Raster::glyph(const uint8_t c, uint8_t *cols) {
 
-#define ST7558_BYTES_CAPACITY   ST7558_WIDTH * (ST7558_HEIGHT + 7) / 8
-#define COLUMNS                 ST7558_WIDTH
-#define PAGES                   ST7558_BYTES_CAPACITY / COLUMNS
+    for (uint8_t i = 0; i < 5; i++) {
+        cols[i] = pgm_read_byte(&font[c * 5 + i]);
+    }
+    cols[5] = 0;                            // spacing column
+}
+#endif
 
-#define WIRE_BEGIN              Wire.begin() 
-#define WIRE_START              Wire.beginTransmission(ST7558_I2C_ADDRESS)
-#define WIRE_END                Wire.endTransmission()
-#define WIRE_WRITE(data)        Wire.write(data)  
+// bus cost of sending n bytes from one address set, in transactions of 
+// at most 'chunk' bytes
+static inline uint16_t _streamCost(const uint16_t n, const uint8_t chunk) {
+    return ST7558_SPAN_OVERHEAD + n + 2 * ((n - 1) / (chunk - 1));
+}
 
-uint8_t _buffer[ST7558_BYTES_CAPACITY];
+// bytes per transaction for a bus: never below ST7558_MIN_BUFFER, so a 
+// full command queue leaves room for data and _streamCost() can't divide 
+// by zero, whatever a custom transport reports
+static inline uint8_t _chunkSize(const uint8_t bufferSize) {
+    return (bufferSize < ST7558_MIN_BUFFER) ? ST7558_MIN_BUFFER : bufferSize;
+}
 
 /*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
 //                  CONSTRUCTOR & DESTRUCTOR                    //   
@@ -67,11 +114,9 @@ uint8_t _buffer[ST7558_BYTES_CAPACITY];
 /** @brief Common constructor
 */
 /**************************************************************/
-ST7558::ST7558(uint8_t rst_pin) : Adafruit_GFX (ST7558_WIDTH, ST7558_HEIGHT) {
-    
-    _rst_pin = rst_pin;
-    clock = 100000;     // standart frequency for most arduinos.
-                        // estimated maximum is 9 fps :( 
+ST7558::ST7558(uint8_t rst_pin) : ST7558(rst_pin, 100000) {
+                        // standart frequency for most arduinos.
+                        // full frames: ~12 fps, partial updates much more
 }
 
 /**************************************************************/
@@ -81,13 +126,74 @@ ST7558::ST7558(uint8_t rst_pin) : Adafruit_GFX (ST7558_WIDTH, ST7558_HEIGHT) {
 ST7558::ST7558(uint8_t rst_pin, uint32_t clock) : Adafruit_GFX (ST7558_WIDTH, ST7558_HEIGHT) {
     
     _rst_pin = rst_pin;
-    if (clock > 300000) {
-        clock = 300000;     // on 300kHz estimated maximum is 23-22 fps
+    if (clock > ST7558_MAX_CLOCK) {
+        clock = ST7558_MAX_CLOCK;   // full frames: ~45 fps at 400kHz, see extras/host
     }
     if (clock < 100000) {
         clock = 100000;
     }
     this->clock = clock;
+    _chunk = _chunkSize(_bus.bufferSize());
+    _buffer = _front = _storage;
+    _back = NULL;
+    _rop = ST7558_ROP_COPY;
+    _rotated = NULL;
+    _rotatedDirty = false;
+    _flips = 0;
+#ifdef ST7558_STRIP_PAGES
+    _stripFirst = 0;
+    _stripLast = ST7558_STRIP_PAGES - 1;
+#endif
+    _flushIndex = ST7558_FLUSH_PAGES;
+    _flushVertical = false;
+    _flushCallback = NULL;
+#ifdef ST7558_ENABLE_PIPELINE
+    _pipeState = ST7558_PIPE_IDLE;
+    _pipeRunning = false;
+    _pipeSkipped = 0;
+    #if defined(ESP32)
+    _pipeTask = NULL;
+    _pipeWaiter = NULL;
+    #endif
+#endif
+    ST7558_STAT(resetStats());
+#ifdef ST7558_ENABLE_RECORDER
+    _recSink = NULL;
+#endif
+    _cmdCount = 0;
+    _fs = _ramX = _ramY = _displayMode = _vop = 0xFF;
+    _mirror = MIRROR_X | MIRROR_Y;          // what begin() sends
+    _columnOffset = ST7558_COLUMN_OFFSET;
+    _pageShift = _rowShift = 0;
+    _deferCommands = false;
+    _pendingMode = _pendingVop = 0xFF;
+    _asleep = _idleSleep = false;
+    _sleepTimeout = _lastActivity = 0;
+    for (uint8_t page = 0; page < ST7558_PAGES; page++) {
+
+        _page[page].prevDirty.min = 0xFF;
+        _page[page].prevDirty.max = 0;
+        _page[page].prevDirty.mask = 0;
+    }
+    _markAllDirty();
+}
+
+/**************************************************************/
+/** @brief Constructor with a custom bus, e.g. 
+           ST7558WireTransport(Wire1) for a second I²C port
+*/
+/**************************************************************/
+ST7558::ST7558(uint8_t rst_pin, const ST7558Bus &bus, uint32_t clock) : ST7558(rst_pin, clock) {
+    _bus = bus;
+    _chunk = _chunkSize(_bus.bufferSize());
+}
+
+ST7558::~ST7558() {   
+
+#ifdef ST7558_ENABLE_PIPELINE
+    stopFlushTask();
+#endif
+    delete _rotated;
 }
 
 /*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
@@ -96,29 +202,35 @@ ST7558::ST7558(uint8_t rst_pin, uint32_t clock) : Adafruit_GFX (ST7558_WIDTH, ST
 
 /**************************************************************/
 /** @brief This method writes cmds or data bytes. 
-           For one I²C transmission session can be transmitted 
-           32 bytes. 
+           One I²C transmission session carries at most the 
+           bus's bufferSize() bytes. With progmem set data is 
+           read from flash
 */
 /**************************************************************/
-void ST7558::_i2cwrite(const uint8_t type, const uint8_t *data, uint8_t n) {
+void ST7558::_i2cwrite(const uint8_t type, const uint8_t *data, uint8_t n, 
+                       const bool progmem) {
     
     uint8_t bytesOut;
-    WIRE_START;
-    WIRE_WRITE(type);                       // <- Co byte, see datasheet
+    ST7558_STAT(_stats.transactions++; _stats.overheadBytes += 2;
+                (type == ST7558_DATA ? _stats.payloadBytes : _stats.overheadBytes) += n);
+    _bus.beginTransmission(ST7558_I2C_ADDRESS);
+    _bus.write(type);                       // <- Co byte, see datasheet
     bytesOut = 1;
     while (n--) {
 
-        if (bytesOut >= I2C_MAX) {
+        if (bytesOut >= _chunk) {
 
-            WIRE_END;
-            WIRE_START;
-            WIRE_WRITE(type);
+            ST7558_STAT(_stats.transactions++; _stats.overheadBytes += 2);
+            _bus.endTransmission();
+            _bus.beginTransmission(ST7558_I2C_ADDRESS);
+            _bus.write(type);
             bytesOut = 1; 
         }
-        WIRE_WRITE(*data++);
+        _bus.write(progmem ? pgm_read_byte(data) : *data);
+        data++;
         bytesOut++;
     } 
-    WIRE_END;
+    _bus.endTransmission();
 }
 
 /**************************************************************/
@@ -136,38 +248,338 @@ inline void ST7558::_hardreset(void) {
 }
 
 /**************************************************************/
-/** @brief This method sets x[0...101](columns) and 
-           y[0...9](pages) address of RAM.
+/** @brief This method queues the x[0...101](columns) and 
+           y[0...8](pages) address of RAM for the next 
+           transaction. x is a framebuffer column, the RAM 
+           column of column 0 (ST7558_COLUMN_OFFSET, or the one 
+           left over on the other side when the X axis is 
+           mirrored) is added here. With vertical set, 
+           data fills a column's pages before moving to the next 
+           column. Parts the controller already has are skipped
 */
 /**************************************************************/
-void ST7558::_setXY(const uint8_t x, const uint8_t y) {
+void ST7558::_setXY(const uint8_t x, const uint8_t y, const bool vertical) {
     
-    uint8_t cmd_setxy[] = {
+    // Function set PD = 0, V = 0/1, H = 0 (basic instruction set)
+    _functionSet(BASIC | (vertical ? VERTICAL_ADDRESSING : HORIZONTAL_ADDRESSING));
 
-        //CONTROL_BYTE,
-        ST7558_FUNCTIONSET | BASIC,         // Function set PD = 0, V = 0, H = 0 (basic instruction set)
-        ST7558_XADDR + x,
-        ST7558_YADDR + y
-    };
-    _i2cwrite(ST7558_CMD, cmd_setxy, sizeof(cmd_setxy));
+    const uint8_t ramX = x + _columnOffset;
+    if (ramX != _ramX) {
+        _command(ST7558_XADDR + ramX);
+        _ramX = ramX;
+    }
+    if (y != _ramY) {
+        _command(ST7558_YADDR + y);
+        _ramY = y;
+    }
+}
+
+/**************************************************************/
+/** @brief This method queues one command for the next 
+           transaction. A full queue is sent on its own first
+*/
+/**************************************************************/
+void ST7558::_command(const uint8_t cmd) {
+    
+    if (_cmdCount == ST7558_CMD_QUEUE) {
+        _transmit(NULL, 0);
+    }
+    _cmd[_cmdCount++] = cmd;
+}
+
+/**************************************************************/
+/** @brief This method queues a function set (PD, V and H bits) 
+           unless the controller is already in that mode
+*/
+/**************************************************************/
+void ST7558::_functionSet(const uint8_t mode) {
+    
+    if (mode != _fs) {
+        _command(ST7558_FUNCTIONSET | mode);
+        _fs = mode;
+    }
+}
+
+/**************************************************************/
+/** @brief This method queues a display control command unless 
+           the display is already in that mode
+*/
+/**************************************************************/
+void ST7558::_queueDisplayMode(const uint8_t mode) {
+    
+    if (mode != _displayMode) {
+        // basic instruction set, addressing mode kept
+        _functionSet(_fs == 0xFF ? BASIC : _fs & VERTICAL_ADDRESSING);
+        _command(ST7558_DISPLAY_CONROL | mode);
+        _displayMode = mode;
+    }
+}
+
+/**************************************************************/
+/** @brief This method queues a contrast (Vop) command unless 
+           the value is already set
+*/
+/**************************************************************/
+void ST7558::_queueContrast(const uint8_t vop) {
+    
+    if (vop != _vop) {
+        _functionSet(EXTENDED);
+        _command(ST7558_VOP + vop);
+        _vop = vop;
+    }
+}
+
+/**************************************************************/
+/** @brief This method queues the commands held back by 
+           deferCommands()
+*/
+/**************************************************************/
+void ST7558::_queuePending(void) {
+    
+    if (_pendingVop != 0xFF) {
+        _queueContrast(_pendingVop);
+        _pendingVop = 0xFF;
+    }
+    if (_pendingMode != 0xFF) {
+        _queueDisplayMode(_pendingMode);
+        _pendingMode = 0xFF;
+    }
+}
+
+/**************************************************************/
+/** @brief This method sends one transaction: the queued 
+           commands, each behind a Co = 1 control byte, then 
+           n data bytes behind a Co = 0 one. Together they must 
+           fit _chunk
+*/
+/**************************************************************/
+void ST7558::_transmit(const uint8_t *data, uint8_t n, const bool progmem) {
+    
+    if (!n) {
+
+        ST7558_STAT(_stats.transactions++; _stats.overheadBytes += 1 + 2 * _cmdCount);
+        _bus.beginTransmission(ST7558_I2C_ADDRESS);
+        for (uint8_t i = 0; i < _cmdCount; i++) {
+            _bus.write(i + 1 == _cmdCount ? ST7558_CMD : ST7558_CMD | ST7558_CONTINUE);
+            _bus.write(_cmd[i]);
+        }
+        _cmdCount = 0;
+        _bus.endTransmission();
+        return;
+    }
+
+    _beginData();
+    for (uint8_t i = 0; i < n; i++) {
+        _bus.write(ST7558Raster::readByte(data++, progmem));
+    }
+    _endData(n);
+}
+
+/**************************************************************/
+/** @brief This method opens a transaction with the queued 
+           commands in front, ready for data bytes written 
+           straight to the bus
+*/
+/**************************************************************/
+void ST7558::_beginData(void) {
+    
+    ST7558_STAT(_stats.transactions++; _stats.overheadBytes += 2 + 2 * _cmdCount);
+    _bus.beginTransmission(ST7558_I2C_ADDRESS);
+    for (uint8_t i = 0; i < _cmdCount; i++) {
+        _bus.write(ST7558_CMD | ST7558_CONTINUE);
+        _bus.write(_cmd[i]);
+    }
+    _cmdCount = 0;
+    _bus.write(ST7558_DATA);                // Co = 0: data up to the STOP
+}
+
+/**************************************************************/
+/** @brief This method closes a data transaction of n bytes. The 
+           RAM pointer is advanced by n, or forgotten if it wraps
+*/
+/**************************************************************/
+void ST7558::_endData(const uint8_t n) {
+    
+    ST7558_STAT(_stats.payloadBytes += n);
+    if (_fs != 0xFF && (_fs & VERTICAL_ADDRESSING)) {
+        if (_ramY + n < ST7558_RAM_PAGES) {
+            _ramY += n;
+        } else {
+            _ramX = _ramY = 0xFF;
+        }
+    } else {
+        if (_ramX + n < ST7558_RAM_WIDTH) {
+            _ramX += n;
+        } else {
+            _ramX = _ramY = 0xFF;
+        }
+    }
+    _bus.endTransmission();
+}
+
+/**************************************************************/
+/** @brief This method marks columns x0...x1 of the page as 
+           changed since the last display() call
+*/
+/**************************************************************/
+inline void ST7558::_markDirty(const uint8_t page, const uint8_t x0, const uint8_t x1) {
+    
+    DirtySpan &dirty = _page[page].dirty;
+    if (x0 < dirty.min) {
+        dirty.min = x0;
+    }
+    if (x1 > dirty.max) {
+        dirty.max = x1;
+    }
+    dirty.mask |= (uint16_t)((2U << (x1 / ST7558_DIRTY_BLOCK)) - (1U << (x0 / ST7558_DIRTY_BLOCK)));
+}
+
+/**************************************************************/
+/** @brief This method records that columns x0...x1 of the page 
+           may hold set pixels
+*/
+/**************************************************************/
+inline void ST7558::_markInk(const uint8_t page, const uint8_t x0, const uint8_t x1) {
+    
+    PageState &ps = _page[page];
+    if (x0 < ps.inkMin) {
+        ps.inkMin = x0;
+    }
+    if (x1 > ps.inkMax) {
+        ps.inkMax = x1;
+    }
+}
+
+/**************************************************************/
+/** @brief Change tracking for the ST7558Raster kernels
+*/
+/**************************************************************/
+inline void ST7558::Marker::operator()(const uint8_t page, const uint8_t x0, 
+                                       const uint8_t x1, const bool ink) const {
+    
+    lcd._markDirty(page, x0, x1);
+    if (ink) {
+        lcd._markInk(page, x0, x1);
+    }
+}
+
+/**************************************************************/
+/** @brief This method marks the whole framebuffer as changed, 
+           so the next display() sends every page
+*/
+/**************************************************************/
+void ST7558::_markAllDirty(void) {
+    
+    for (uint8_t page = 0; page < ST7558_PAGES; page++) {
+        _page[page].inkMin = 0;
+        _page[page].inkMax = ST7558_WIDTH - 1;
+        _markDirty(page, 0, ST7558_WIDTH - 1);
+    }
+    _fullFlush = true;
+}
+
+/**************************************************************/
+/** @brief This method narrows a page's span to the columns where 
+           the frame about to be shown (_front) differs from the 
+           one on screen (_buffer, right after a swap)
+*/
+/**************************************************************/
+void ST7558::_trimToChanges(const uint8_t page, DirtySpan &span) {
+    
+    const uint8_t *shown = &_buffer[ST7558_WIDTH * page];
+    const uint8_t *next = &_front[ST7558_WIDTH * page];
+    uint8_t min = 0xFF, max = 0;
+    uint16_t mask = 0;
+
+    for (uint8_t x = span.min; x <= span.max; x++) {
+
+        const uint16_t block = 1U << (x / ST7558_DIRTY_BLOCK);
+        if ((span.mask & block) && next[x] != shown[x]) {
+            if (min == 0xFF) {
+                min = x;
+            }
+            max = x;
+            mask |= block;
+        }
+    }
+    span.min = min;
+    span.max = max;
+    span.mask = mask;
+}
+
+/**************************************************************/
+/** @brief This method finds the next span of a page to send, 
+           starting at column 'from'. Neighbouring dirty blocks 
+           are merged while the clean gap between them is cheaper 
+           to resend than ST7558_SPAN_OVERHEAD bytes of a new 
+           address set and transaction.
+    @return false if nothing is left to send in this page
+*/
+/**************************************************************/
+bool ST7558::_nextSpan(const DirtySpan &dirty, const uint8_t from, 
+                       uint8_t &x0, uint8_t &x1) {
+    
+    const uint8_t lo = from > dirty.min ? from : dirty.min;
+    bool found = false;
+
+    if (lo > dirty.max) {
+        return false;
+    }
+    for (uint8_t block = lo / ST7558_DIRTY_BLOCK; 
+         block <= dirty.max / ST7558_DIRTY_BLOCK; block++) {
+
+        if (!(dirty.mask & (1U << block))) {
+            continue;
+        }
+        uint8_t bx0 = block * ST7558_DIRTY_BLOCK;
+        uint8_t bx1 = bx0 + ST7558_DIRTY_BLOCK - 1;
+        if (bx0 < lo) {
+            bx0 = lo;
+        }
+        if (bx1 > dirty.max) {
+            bx1 = dirty.max;
+        }
+
+        if (!found) {
+            x0 = bx0;
+            x1 = bx1;
+            found = true;
+        } else if (bx0 - x1 - 1 <= ST7558_SPAN_OVERHEAD) {
+            x1 = bx1;                       // cheaper to resend the gap
+        } else {
+            break;                          // cheaper to open a new span
+        }
+    }
+    return found;
 }
 
 /**************************************************************/
 /** @brief This method makes initial display setup
 */
 /**************************************************************/
-void ST7558::begin(void) {
+bool ST7558::begin(void) {
     
-    WIRE_BEGIN;
-    Wire.setClock(clock);
+    _bus.begin(clock);
+    _chunk = _chunkSize(_bus.bufferSize());
     clearDisplay();
     _hardreset();
 
+    // the controller must ACK at the requested clock; on a slow bus 
+    // (weak pull-ups, long wires) step down to 400kHz, then to 100kHz
+    bool ready = _bus.probe(ST7558_I2C_ADDRESS);
+    while (!ready && clock > 100000) {
+
+        clock = (clock > 400000) ? 400000 : 100000;
+        _bus.setClock(clock);
+        ready = _bus.probe(ST7558_I2C_ADDRESS);
+    }
+
     // main lcd initialization 
+    const uint8_t mirror = (ST7558_EXTENDED_DISPAY_CONTROL & ~(MIRROR_X | MIRROR_Y)) | _mirror;
     uint8_t cmd_init[] = {
 
         //CONTROL_BYTE,
-        ST7558_EXTENDED_DISPAY_CONTROL,         // Ext. display control | MX = 1, MY = 1
+        mirror,                                 // Ext. display control | MX = 1, MY = 1 unless rotated
         ST7558_FUNCTIONSET | EXTENDED,          // Function set PD = 0, V = 0, H = 1 (extended instruction set)
         ST7558_SYSTEM_BIAS,
         ST7558_VOP | DEFAULT_VOP,
@@ -181,6 +593,25 @@ void ST7558::begin(void) {
         ST7558_XADDR                          
     };
     _i2cwrite(ST7558_CMD, cmd_init, sizeof(cmd_init)); 
+    _cmdCount = 0;
+    _fs = BASIC;
+    _ramX = _ramY = 0;
+    _displayMode = ON;
+    _vop = DEFAULT_VOP;
+    _asleep = _idleSleep = false;
+    _lastActivity = millis();
+    _markAllDirty();                        // RAM content after reset is unknown
+    return ready;
+}
+
+/**************************************************************/
+/** @brief This method returns the bus clock in use, which 
+           begin() may have lowered from the requested one
+*/
+/**************************************************************/
+uint32_t ST7558::getClock(void) {
+
+    return clock;
 }
 
 /****************************************************************/
@@ -192,13 +623,14 @@ void ST7558::begin(void) {
 /****************************************************************/
 void ST7558::invertDisplay(const bool state) {
     
-    uint8_t cmd_invert[] = {
-
-        //CONTROL_BYTE,
-        ST7558_FUNCTIONSET | BASIC,                         // Function set PD = 0, V = 0, H = 0 (basic instruction set)
-        ST7558_DISPLAY_CONROL | ON | state,      // Display control D = 1, E = 1 (Invert video mode)
-    };
-    _i2cwrite(ST7558_CMD, cmd_invert, sizeof(cmd_invert));
+    // Display control D = 1, E = 1 (Invert video mode)
+    const uint8_t mode = ON | state;
+    if (_deferCommands || _asleep) {
+        _pendingMode = mode;
+    } else {
+        _queueDisplayMode(mode);
+        _transmit(NULL, 0);
+    }
 }
 
 /**************************************************************/
@@ -207,13 +639,13 @@ void ST7558::invertDisplay(const bool state) {
 /**************************************************************/
 void ST7558::displayOff(void) {
     
-    uint8_t cmd_off[] = {
-
-        //CONTROL_BYTE,
-        ST7558_FUNCTIONSET | BASIC,                         // Function set PD = 0, V = 0, H = 0 (basic instruction set)
-        ST7558_DISPLAY_CONROL | OFF,                        // Display control D = 0, E = 0 (Display off)
-    };
-    _i2cwrite(ST7558_CMD, cmd_off, sizeof(cmd_off));
+    // Display control D = 0, E = 0 (Display off)
+    if (_deferCommands || _asleep) {
+        _pendingMode = OFF;
+    } else {
+        _queueDisplayMode(OFF);
+        _transmit(NULL, 0);
+    }
 }
 
 /**************************************************************/
@@ -222,13 +654,13 @@ void ST7558::displayOff(void) {
 /**************************************************************/
 void ST7558::displayOn(void) {
     
-    uint8_t cmd_on[] = {
-
-        //CONTROL_BYTE,
-        ST7558_FUNCTIONSET | BASIC,                         // Function set PD = 0, V = 0, H = 0 (basic instruction set)
-        ST7558_DISPLAY_CONROL | ON,                         // Display control D = 1, E = 0 (Normal mode)
-    };
-    _i2cwrite(ST7558_CMD, cmd_on, sizeof(cmd_on));
+    // Display control D = 1, E = 0 (Normal mode)
+    if (_deferCommands || _asleep) {
+        _pendingMode = ON;
+    } else {
+        _queueDisplayMode(ON);
+        _transmit(NULL, 0);
+    }
 }
 
 /***************************************************************/
@@ -239,117 +671,1468 @@ void ST7558::displayOn(void) {
 /****************************************************************/
 void ST7558::setContrast(const uint8_t value) {
     
-    uint8_t cmd_set_contrast[] = {
+    const uint8_t vop = value & 0b01111111;
+    if (_deferCommands || _asleep) {
+        _pendingVop = vop;
+    } else {
+        _queueContrast(vop);
+        _transmit(NULL, 0);
+    }
+}
 
-        //CONTROL_BYTE
-        ST7558_FUNCTIONSET | EXTENDED,
-        ST7558_VOP + ( value & 0b01111111)
-    };
+/****************************************************************/
+/** @brief  Hold setContrast(), invertDisplay(), displayOn() and 
+            displayOff() back until the next flush. Only the 
+            latest of each is kept, and it rides in the flush's 
+            first transaction instead of costing its own. Turning 
+            this off sends what is still held
+    @param  state   true - defer, false - send right away
+*/
+/****************************************************************/
+void ST7558::deferCommands(const bool state) {
     
-    _i2cwrite(ST7558_CMD, cmd_set_contrast, sizeof(cmd_set_contrast));
+#ifdef ST7558_ENABLE_PIPELINE
+    if (_pipeRunning) {
+        _pipeDefer = state;                 // the task owns the bus until stopped
+        return;
+    }
+#endif
+    _deferCommands = state;
+    if (!state && !_asleep) {
+        _queuePending();
+        if (_cmdCount) {
+            _transmit(NULL, 0);
+        }
+    }
 }
 
 /**************************************************************/
-/** @brief  This method sets all framebuffer bits to zero
+/** @brief  Put the controller in power down mode: the glass goes 
+            blank, the charge pump stops and the display data RAM 
+            keeps its content. A running flush is completed first. 
+            While asleep flushes send nothing and display commands 
+            are held; the changes go out after wake()
 */
 /**************************************************************/
-void ST7558::clearDisplay(void) { 
-    memset(_buffer, 0x00, ST7558_BYTES_CAPACITY); 
+void ST7558::sleep(void) {
+
+    if (_asleep) {
+        return;
+    }
+    waitFlush();
+    // Function set PD = 1, H = 0, addressing mode kept
+    _functionSet(POWER_DOWN_MODE | (_fs == 0xFF ? BASIC : _fs & VERTICAL_ADDRESSING));
+    _transmit(NULL, 0);
+    _asleep = true;
+    _idleSleep = false;
 }
 
 /**************************************************************/
-/** @brief This method writes all framebuffer to the ST7558 RAM 
+/** @brief  Leave power down mode. The RAM still holds the last 
+            frame, so it is visible again after one command, 
+            without begin() or resending the framebuffer. Display 
+            commands held while asleep ride in the same 
+            transaction, unless deferCommands() is on
 */
 /**************************************************************/
-void ST7558::display(void) {   
-    
-    _setXY(0,0);
-
-    uint8_t column, 
-            page,
-            buff[96];
+void ST7558::wake(void) {
 
-    for (page = 0; page < PAGES; page++) {
-        column = 0;
-        _setXY(column,page);
-
-        while (column < COLUMNS) {
-
-            buff[column] = _buffer[ST7558_WIDTH * page + column]; 
-            column++;
-        }
-        _i2cwrite(ST7558_DATA, buff, sizeof(buff));
+    if (!_asleep) {
+        return;
+    }
+    _powerUp();
+    if (!_deferCommands) {
+        _queuePending();
     }
+    _transmit(NULL, 0);
 }
 
+bool ST7558::isAsleep(void) {
+    return _asleep;
+}
 
-/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
-//                     FEEDBACK FUNCTIONS                       //   
-/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+#ifndef ST7558_STRIP_PAGES
+/**************************************************************/
+/** @brief  Go to sleep when flushes have sent nothing for a 
+            while. The flush that finds the timeout expired puts 
+            the controller in power down mode, and the first one 
+            with something to send wakes it again, in the same 
+            transaction. Keep calling display() (or displayAsync(), 
+            present()) in the loop even when nothing is drawn
+    @param  ms  idle time before sleeping, 0 - never
+*/
+/**************************************************************/
+void ST7558::setSleepTimeout(const uint32_t ms) {
 
-uint8_t ST7558::getPixel(const uint8_t x, const uint8_t y) {
+    _sleepTimeout = ms;
+    _lastActivity = millis();
+}
+#endif
 
-    if ((x >= 0 && x < ST7558_WIDTH) 
-    && (y >= 0 && y < ST7558_HEIGHT)) {
-        return ((1>>y%8) & _buffer[x + (y/8) * ST7558_WIDTH]);
-    }  
+/**************************************************************/
+/** @brief  This method queues the power down exit for the next 
+            transaction
+*/
+/**************************************************************/
+void ST7558::_powerUp(void) {
+
+    // Function set PD = 0, H = 0, addressing mode kept
+    _functionSet(_fs & VERTICAL_ADDRESSING);
+    _asleep = _idleSleep = false;
+    _lastActivity = millis();
 }
 
 /**************************************************************/
-/** @brief Get memory pointer to the framebuffer
-    @return Pointer to the first framebuffer's element 
+/** @brief  This method sets all framebuffer bits to zero. Only 
+            columns which may hold set pixels become dirty
 */
 /**************************************************************/
-uint8_t *ST7558::getBuffer(void) { 
-    return _buffer; 
+void ST7558::clearDisplay(void) { 
+    
+    if (_rotated) {
+        memset(_rotated->getBuffer(), 0x00, _rotated->getBufferSize());
+        _rotatedDirty = true;
+        return;
+    }
+#ifdef ST7558_STRIP_PAGES
+    memset(_buffer, 0x00, ST7558_STORAGE_SIZE);
+#else
+    for (uint8_t page = 0; page < ST7558_PAGES; page++) {
+
+        PageState &ps = _page[page];
+        if (ps.inkMin <= ps.inkMax) {
+            memset(&_buffer[ST7558_WIDTH * page + ps.inkMin], 0x00, ps.inkMax - ps.inkMin + 1);
+            _markDirty(page, ps.inkMin, ps.inkMax);
+            ps.inkMin = 0xFF;
+            ps.inkMax = 0;
+        }
+    }
+#endif
 }
 
+#ifndef ST7558_STRIP_PAGES
 /**************************************************************/
-/** @brief Get size of the framebuffer in bytes
-    @return Size in bytes
+/** @brief This method writes changed parts of the framebuffer 
+           to the ST7558 RAM. A flush started by displayAsync() is 
+           completed first
 */
 /**************************************************************/
-uint16_t ST7558::getBufferSize(void) {
-    return ST7558_BYTES_CAPACITY; 
+void ST7558::display(void) {   
+    
+#ifdef ST7558_ENABLE_PIPELINE
+    if (_pipeRunning) {
+        _pipeSubmit(true);
+        waitFlush();
+        return;
+    }
+#endif
+    waitFlush();
+    _bus.beginFrame();
+    beginFlush();
+    while (_flushStep());
+    _bus.endFrame();
 }
 
-/***************************************************************/
-/** @brief Push another buffer
+/**************************************************************/
+/** @brief This method writes all framebuffer to the ST7558 RAM, 
+           changed or not
 */
-/***************************************************************/
-void ST7558::pushBuffer(uint8_t *buffer, const uint16_t size) { 
-    memmove(_buffer, buffer, size); 
+/**************************************************************/
+void ST7558::displayFull(void) {   
+    
+    for (uint8_t page = 0; page < ST7558_PAGES; page++) {
+        _markDirty(page, 0, ST7558_WIDTH - 1);
+    }
+    _fullFlush = true;
+    display();
 }
+#endif
 
 
 /*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
-//                      DRAWING FUNCTIONS                       //   
+//                          STRIP MODE                          //   
 /*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
 
-/****************************************************************/
-/** @brief  Draw one pixel to the framebuffer
-    @param  x   x coordinate
-    @param  y   y coordinate
-    @param  color 
+#ifdef ST7558_STRIP_PAGES
+/**************************************************************/
+/** @brief Start drawing a frame in strip mode. Draw the whole 
+           scene after it and call nextPage() until it returns 
+           false; the scene is drawn once per strip and clipped 
+           to it:
+
+           lcd.firstPage();
+           do {
+               lcd.drawRect(...);
+           } while (lcd.nextPage());
 */
-/****************************************************************/
-void ST7558::drawPixel (int16_t x, int16_t y, 
-                     uint16_t color) {
+/**************************************************************/
+void ST7558::firstPage(void) {   
+    
+    waitFlush();                            // a displayFrame() may be running
+    _stripFirst = 0;
+    _stripLast = ST7558_STRIP_PAGES - 1;
+    memset(_buffer, 0x00, ST7558_STORAGE_SIZE);
+    ST7558_STAT(_flushStarted = micros(); _flushBytes = 0);
+}
 
-    if ((x >= 0 && x < ST7558_WIDTH) 
-    && (y >= 0 && y < ST7558_HEIGHT)) {
+/**************************************************************/
+/** @brief Send the strip just drawn and move to the next one
+    @return false when the last strip has been sent
+*/
+/**************************************************************/
+bool ST7558::nextPage(void) {   
+    
+    _sendStrip();
+    if (_stripLast == ST7558_PAGES - 1) {
 
-        color ?
-        _buffer[x + (y/8) * ST7558_WIDTH] |= (1 << y%8)
-        :
-        _buffer[x + (y/8) * ST7558_WIDTH] &= ~(1 << y%8);
+        ST7558_STAT(_statsFlushDone());
+        _stripFirst = 0;                    // stray drawing lands in the first strip
+        _stripLast = ST7558_STRIP_PAGES - 1;
+        return false;
+    }
+    _stripFirst += ST7558_STRIP_PAGES;
+    _stripLast += ST7558_STRIP_PAGES;
+    if (_stripLast > ST7558_PAGES - 1) {
+        _stripLast = ST7558_PAGES - 1;
     }
+    memset(_buffer, 0x00, ST7558_STORAGE_SIZE);
+    return true;
 }
 
-/****************************************************************/
-/** @brief  Draw rectangle to the framebuffer
-    @param  x   x coordinate
-    @param  y   y coordinate
+/**************************************************************/
+/** @brief This method sends the pages of the current strip, 
+           one address set per page. Deferred commands ride 
+           with the first strip
+*/
+/**************************************************************/
+void ST7558::_sendStrip(void) {   
+    
+    if (_asleep) {
+        return;
+    }
+    _bus.beginFrame();
+    if (!_stripFirst) {
+        _queuePending();
+    }
+    for (uint8_t page = _stripFirst; page <= _stripLast; page++) {
+
+        const uint8_t *row = &_buffer[ST7558_WIDTH * (page - _stripFirst)];
+        _setXY(0, page);
+        for (uint8_t x = 0; x < ST7558_WIDTH; ) {
+
+            const uint8_t room = _chunk - 1 - 2 * _cmdCount;
+            const uint8_t n = (ST7558_WIDTH - x < room) ? ST7558_WIDTH - x : room;
+            _transmit(&row[x], n);
+            x += n;
+        }
+    }
+    ST7558_STAT(_flushBytes += ST7558_WIDTH * (_stripLast - _stripFirst + 1));
+    _bus.endFrame();
+}
+#endif
+
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+//                       NON-BLOCKING FLUSH                     //   
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+
+#ifndef ST7558_STRIP_PAGES
+/**************************************************************/
+/** @brief Start sending the changed parts of the framebuffer 
+           without blocking, see beginFlush(), and send the 
+           first chunk right away
+    @return false if the previous flush is still running or the 
+            display sleeps
+*/
+/**************************************************************/
+bool ST7558::displayAsync(void) {   
+    
+#ifdef ST7558_ENABLE_PIPELINE
+    if (_pipeRunning) {
+        return present();
+    }
+#endif
+    if (!beginFlush()) {
+        return false;
+    }
+    _flushStep();
+    return true;
+}
+
+/**************************************************************/
+/** @brief Snapshot what needs sending and reset the dirty state, 
+           so drawing can go on while the transfer is advanced 
+           by poll(). The framebuffer itself is read as the 
+           transfer goes: pixels drawn meanwhile show up in this 
+           flush or the next one.
+           
+           With a back buffer set (see setBackBuffer()) the draw 
+           target is swapped with the shown buffer first: the 
+           finished frame is sent untouched and drawing goes on 
+           in the other buffer, which holds the frame before.
+    @return false if the previous flush is still running or the 
+            display sleeps (see sleep())
+*/
+/**************************************************************/
+bool ST7558::beginFlush(void) {   
+    
+    if (isBusy()) {
+        return false;
+    }
+    _transposeRotated();
+    if (_asleep) {
+
+        bool changed = false;
+        for (uint8_t page = 0; page < ST7558_PAGES; page++) {
+            changed |= _page[page].dirty.min <= _page[page].dirty.max;
+        }
+        if (!_idleSleep || !changed) {
+            return false;                   // held until wake()
+        }
+        _powerUp();                         // rides in the flush's first transaction
+    }
+
+    const bool swap = _front != _buffer;
+    if (swap) {
+
+        uint8_t *shown = _front;
+        _front = _buffer;
+        _buffer = shown;
+    }
+    for (uint8_t page = 0; page < ST7558_PAGES; page++) {
+
+        PageState &ps = _page[page];
+        DirtySpan &flush = _flushPage[page];
+        flush = ps.dirty;
+        if (swap) {
+
+            // the new frame was last shown two flushes ago, so it 
+            // differs from the screen where it has been drawn on 
+            // since or where the last flush changed the screen. 
+            // Cut that down to the bytes that really differ; the 
+            // result is what this flush changes on screen
+            if (ps.prevDirty.min < flush.min) {
+                flush.min = ps.prevDirty.min;
+            }
+            if (ps.prevDirty.max > flush.max) {
+                flush.max = ps.prevDirty.max;
+            }
+            flush.mask |= ps.prevDirty.mask;
+            if (!_fullFlush) {
+                _trimToChanges(page, flush);
+            }
+            ps.prevDirty = flush;
+
+            const uint8_t inkMin = ps.inkMin, inkMax = ps.inkMax;
+            ps.inkMin = ps.otherInkMin;
+            ps.inkMax = ps.otherInkMax;
+            ps.otherInkMin = inkMin;
+            ps.otherInkMax = inkMax;
+        }
+        ps.dirty.min = 0xFF;
+        ps.dirty.max = 0;
+        ps.dirty.mask = 0;
+    }
+    _fullFlush = false;
+    _flushSource = _front;
+    _flushProgmem = false;
+    _flushStart();
+    if (!isBusy() && _sleepTimeout && millis() - _lastActivity >= _sleepTimeout) {
+
+        sleep();
+        _idleSleep = true;
+    }
+    return true;
+}
+#endif
+
+/**************************************************************/
+/** @brief Start sending a whole precomputed frame stored in 
+           PROGMEM, without copying it into the framebuffer. 
+           The framebuffer is sent again by the next flush
+    @param  frame   page-major frame of getBufferSize() bytes
+    @return false if the previous flush is still running or the 
+            display sleeps
+*/
+/**************************************************************/
+bool ST7558::beginFlush(const uint8_t *frame) {   
+    
+    if (isBusy()) {
+        return false;
+    }
+    if (_asleep) {
+
+        if (!_idleSleep) {
+            return false;                   // held until wake()
+        }
+        _powerUp();
+    }
+    for (uint8_t page = 0; page < ST7558_PAGES; page++) {
+
+        _markDirty(page, 0, ST7558_WIDTH - 1);
+        _flushPage[page] = _page[page].dirty;
+    }
+    _fullFlush = true;                      // RAM holds this frame, not the framebuffer
+    _flushSource = frame;
+    _flushProgmem = true;
+    _flushStart();
+    return true;
+}
+
+/**************************************************************/
+/** @brief Send a whole precomputed frame stored in PROGMEM, 
+           see beginFlush(const uint8_t *)
+*/
+/**************************************************************/
+void ST7558::displayFrame(const uint8_t *frame) {   
+    
+    waitFlush();
+    _bus.beginFrame();
+    beginFlush(frame);
+    while (_flushStep());
+    _bus.endFrame();
+}
+
+/**************************************************************/
+/** @brief Move the running flush forward. Without a budget one 
+           I²C transaction (address set and one data chunk, at 
+           most the bus's bufferSize() bytes) is sent, with a 
+           budget chunks are sent until it is used up
+    @param  budget_us   time budget in microseconds, 0 - one chunk
+    @return true while the flush is still running
+*/
+/**************************************************************/
+bool ST7558::poll(const uint16_t budget_us) {   
+    
+#ifdef ST7558_ENABLE_PIPELINE
+    if (_pipeRunning) {
+        return _pipeState.load(std::memory_order_acquire) != ST7558_PIPE_IDLE;
+    }
+#endif
+    const uint32_t start = micros();
+    while (_flushStep() && budget_us && (micros() - start) < budget_us);
+    return isBusy();
+}
+
+/**************************************************************/
+/** @brief Check for a running flush
+    @return true until the last chunk has been sent
+*/
+/**************************************************************/
+bool ST7558::isBusy(void) {   
+    return _flushIndex < ST7558_FLUSH_PAGES;
+}
+
+/**************************************************************/
+/** @brief Block until the running flush has been sent, by the 
+           flush task if one is running
+*/
+/**************************************************************/
+void ST7558::waitFlush(void) {   
+    
+#ifdef ST7558_ENABLE_PIPELINE
+    if (_pipeRunning) {
+
+    #if defined(ESP32)
+        _pipeWaiter = xTaskGetCurrentTaskHandle();
+        while (_pipeState.load(std::memory_order_acquire) != ST7558_PIPE_IDLE) {
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        }
+        _pipeWaiter = NULL;
+    #else
+        std::unique_lock<std::mutex> lock(_pipeLock);
+        _pipeWake.wait(lock, [this] { 
+            return _pipeState.load(std::memory_order_acquire) == ST7558_PIPE_IDLE; 
+        });
+    #endif
+        return;
+    }
+#endif
+    if (isBusy()) {
+        _bus.beginFrame();
+        while (_flushStep());
+        _bus.endFrame();
+    }
+}
+
+/**************************************************************/
+/** @brief Set a function called each time a flush completes,
+           NULL to remove it
+*/
+/**************************************************************/
+void ST7558::onFlushComplete(ST7558FlushCallback callback) {   
+    _flushCallback = callback;
+}
+
+/**************************************************************/
+/** @brief This method starts walking the flush snapshot
+*/
+/**************************************************************/
+void ST7558::_flushStart(void) {   
+    
+    ST7558_STAT(_flushStarted = micros(); _flushBytes = 0);
+#ifdef ST7558_ENABLE_RECORDER
+    _recordFrame();
+#endif
+#if ST7558_FLUSH_PAGES > ST7558_PAGES
+    _flushPage[ST7558_PAGES].min = 0xFF;
+    _flushPage[ST7558_PAGES].max = 0;
+    _flushPage[ST7558_PAGES].mask = 0;
+#endif
+    if (_rowShift) {
+
+        // each page's bottom rows land in the next RAM page
+        for (uint8_t page = ST7558_FLUSH_PAGES - 1; page > 0; page--) {
+
+            DirtySpan &span = _flushPage[page];
+            const DirtySpan &above = _flushPage[page - 1];
+            if (above.min < span.min) {
+                span.min = above.min;
+            }
+            if (above.max > span.max) {
+                span.max = above.max;
+            }
+            span.mask |= above.mask;
+        }
+    }
+    _queuePending();
+    _flushIndex = 0;
+    _flushFrom = 0;
+    _flushVertical = _pickVertical();
+    if (_flushVertical) {
+        _flushAddress = true;
+    } else {
+        _flushAdvance();
+    }
+    if (isBusy()) {
+        _lastActivity = millis();
+    } else if (_cmdCount) {
+        _transmit(NULL, 0);                 // nothing to draw, send the commands alone
+    }
+}
+
+/**************************************************************/
+/** @brief This method compares the bus cost of the flush 
+           snapshot sent as horizontal spans with the cost of 
+           one vertical-addressing block over the same columns. 
+           Vertically the RAM pointer walks down a column, wraps 
+           from the last RAM page to page 0 of the next column, 
+           so one address set covers the block, at the price of 
+           resending its clean bytes. That wins for tall, narrow 
+           changes and for full frames narrower than the RAM
+    @return true if the vertical block is cheaper, its bounds 
+            are then set up in _flushX/_flushY/_flushEnd/_flushLast
+*/
+/**************************************************************/
+bool ST7558::_pickVertical(void) {   
+    
+    uint8_t x0 = 0xFF, x1 = 0, p0 = 0xFF, p1 = 0;
+    uint16_t horizontal = 0;
+
+    for (uint8_t page = 0; page < ST7558_FLUSH_PAGES; page++) {
+
+        const DirtySpan &dirty = _flushPage[page];
+        if (dirty.min > dirty.max) {
+            continue;
+        }
+        if (dirty.min < x0) {
+            x0 = dirty.min;
+        }
+        if (dirty.max > x1) {
+            x1 = dirty.max;
+        }
+        if (p0 == 0xFF) {
+            p0 = page;
+        }
+        p1 = page;
+
+        uint8_t from = 0, s0, s1;
+        while (_nextSpan(dirty, from, s0, s1)) {
+            horizontal += _streamCost(s1 - s0 + 1, _chunk);
+            from = s1 + 1;
+        }
+    }
+    if (p0 == 0xFF) {
+        return false;
+    }
+
+    const uint16_t n = (x1 - x0) * ST7558_RAM_PAGES + p1 - p0 + 1;
+    if (_streamCost(n, _chunk) >= horizontal) {
+        return false;
+    }
+    _flushX = x0;
+    _flushY = p0 + _pageShift;
+    _flushEnd = x1;
+    _flushLast = p1 + _pageShift;
+    return true;
+}
+
+/**************************************************************/
+/** @brief This method finds the next span of the flush snapshot 
+           and prepares to address it, or finishes the flush
+*/
+/**************************************************************/
+void ST7558::_flushAdvance(void) {   
+    
+    uint8_t x0, x1;
+
+    while (_flushIndex < ST7558_FLUSH_PAGES) {
+
+        if (_nextSpan(_flushPage[_flushIndex], _flushFrom, x0, x1)) {
+
+            _flushX = x0;
+            _flushEnd = x1;
+            _flushFrom = x1 + 1;
+            _flushAddress = true;
+            return;
+        }
+        _flushIndex++;
+        _flushFrom = 0;
+    }
+    ST7558_STAT(_statsFlushDone());
+    if (_flushCallback) {
+        _flushCallback();
+    }
+}
+
+/**************************************************************/
+/** @brief This method reads the RAM byte a flush sends for a 
+           page and column: the framebuffer's, zero below it. 
+           Pages count from the frame's first RAM page. With the 
+           Y axis mirrored the frame sits _rowShift rows lower 
+           in them, so the top rows come from the page above
+*/
+/**************************************************************/
+inline uint8_t ST7558::_flushByte(const uint8_t page, const uint8_t x) {   
+    
+    uint8_t b = (page < ST7558_PAGES) 
+        ? ST7558Raster::readByte(&_flushSource[ST7558_WIDTH * page + x], _flushProgmem) 
+        : 0x00;
+    if (_rowShift) {
+
+        b <<= _rowShift;
+        if (page > 0 && page <= ST7558_PAGES) {
+            b |= ST7558Raster::readByte(&_flushSource[ST7558_WIDTH * (page - 1) + x], _flushProgmem) 
+                 >> (8 - _rowShift);
+        }
+    }
+    return b;
+}
+
+/**************************************************************/
+/** @brief This method sends one I²C transaction of the running 
+           flush
+    @return false if no flush is running
+*/
+/**************************************************************/
+bool ST7558::_flushStep(void) {   
+    
+    if (!isBusy()) {
+        return false;
+    }
+    if (_flushAddress) {
+
+        _setXY(_flushX, _flushVertical ? _flushY : _flushIndex + _pageShift, _flushVertical);
+        _flushAddress = false;
+    }
+
+    // queued commands share the transaction with the data
+    const uint8_t room = _chunk - 1 - 2 * _cmdCount;
+    if (_flushVertical) {
+
+        // column-major walk; RAM pages below the panel get zeros
+        uint8_t n = 0;
+        bool done = false;
+        _beginData();
+        while (n < room && !done) {
+
+            _bus.write(_flushByte((uint8_t)(_flushY - _pageShift), _flushX));
+            n++;
+            done = _flushX == _flushEnd && _flushY == _flushLast;
+            if (++_flushY == ST7558_RAM_PAGES) {
+                _flushY = 0;
+                _flushX++;
+            }
+        }
+        _endData(n);
+        ST7558_STAT(_flushBytes += n);
+        if (done) {
+            _flushVertical = false;
+            _flushIndex = ST7558_FLUSH_PAGES;
+            _flushAdvance();                // nothing left, runs the callback
+        }
+        return true;
+    }
+
+    uint8_t n = _flushEnd - _flushX + 1;
+    if (n > room) {
+        n = room;
+    }
+    if (_rowShift) {
+
+        _beginData();
+        for (uint8_t i = 0; i < n; i++) {
+            _bus.write(_flushByte(_flushIndex, _flushX + i));
+        }
+        _endData(n);
+    } else {
+        _transmit(&_flushSource[ST7558_WIDTH * _flushIndex + _flushX], n, _flushProgmem);
+    }
+    ST7558_STAT(_flushBytes += n);
+    _flushX += n;
+    if (_flushX > _flushEnd) {
+        _flushAdvance();
+    }
+    return true;
+}
+
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+//                       BACKGROUND FLUSH                       //   
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+
+#ifdef ST7558_ENABLE_PIPELINE
+/**************************************************************/
+/** @brief Send frames from a background task (ESP32) or thread 
+           (Linux), so the next frame is drawn while the bus 
+           sends this one. Drawing goes to the back buffer, 
+           present() swaps it with the shown one and hands the 
+           changes to the task. While it runs:
+           
+           - display() hands the frame over and waits for it
+           - displayAsync() is present()
+           - setContrast(), invertDisplay(), displayOn/Off() are 
+             deferred and go out with the next frame
+           - the flush callback is called from the task
+    @param  backBuffer  caller-owned buffer of getBufferSize() 
+                        bytes, see setBackBuffer()
+    @param  policy      what present() does while the task is 
+                        still sending, see ST7558FrameSkip
+    @return false without a back buffer or if the task can't 
+            be created
+*/
+/**************************************************************/
+bool ST7558::startFlushTask(uint8_t *backBuffer, ST7558FrameSkip policy) {   
+    
+    _pipeSkip = policy;
+    if (_pipeRunning) {
+        return true;
+    }
+    if (!backBuffer) {
+        return false;
+    }
+    setBackBuffer(backBuffer);
+    _pipeSkipped = 0;
+    _pipeDefer = _deferCommands;
+    _deferCommands = true;                  // commands only go out with frames
+    _pipeState = ST7558_PIPE_IDLE;
+#if defined(ESP32)
+    if (xTaskCreatePinnedToCore(_pipeMain, "st7558", ST7558_PIPELINE_STACK, this, 
+                                ST7558_PIPELINE_PRIORITY, &_pipeTask, 
+                                ST7558_PIPELINE_CORE) != pdPASS) {
+        _deferCommands = _pipeDefer;
+        return false;
+    }
+#else
+    _pipeThread = std::thread(_pipeMain, this);
+#endif
+    _pipeRunning = true;
+    return true;
+}
+
+/**************************************************************/
+/** @brief Let the task send the frame in flight, then stop it. 
+           Double buffering stays on
+*/
+/**************************************************************/
+void ST7558::stopFlushTask(void) {   
+    
+    if (!_pipeRunning) {
+        return;
+    }
+    waitFlush();
+    _pipeRelease(ST7558_PIPE_STOP);
+#if defined(ESP32)
+    while (_pipeState.load(std::memory_order_acquire) != ST7558_PIPE_DONE) {
+        vTaskDelay(1);
+    }
+    _pipeTask = NULL;
+#else
+    _pipeThread.join();
+#endif
+    _pipeState = ST7558_PIPE_IDLE;
+    _pipeRunning = false;
+    deferCommands(_pipeDefer);
+}
+
+/**************************************************************/
+/** @brief Hand the frame drawn so far to the flush task. If it 
+           is still sending the last one, the frame is skipped or 
+           waited for, as set in startFlushTask(). A skipped 
+           frame's changes stay dirty and go with the next one. 
+           Without a running task this is display()
+    @return false if the frame was skipped
+*/
+/**************************************************************/
+bool ST7558::present(void) {   
+    
+    if (!_pipeRunning) {
+        display();
+        return true;
+    }
+    return _pipeSubmit(_pipeSkip == ST7558_WAIT_FRAME);
+}
+
+/**************************************************************/
+/** @brief Get the number of frames present() has skipped since 
+           startFlushTask()
+*/
+/**************************************************************/
+uint32_t ST7558::getSkippedFrames(void) {   
+    return _pipeSkipped;
+}
+
+/**************************************************************/
+/** @brief This method fills the handoff slot, on the app's side. 
+           Once the task has given the slot back nothing of the 
+           flush state is touched by it, so beginFlush() can run 
+           here as usual
+*/
+/**************************************************************/
+bool ST7558::_pipeSubmit(const bool wait) {   
+    
+    if (_pipeState.load(std::memory_order_acquire) != ST7558_PIPE_IDLE) {
+        if (!wait) {
+            _pipeSkipped++;
+            return false;
+        }
+        waitFlush();
+    }
+    beginFlush();                           // swap, snapshot, queue deferred commands
+    if (isBusy()) {
+        _pipeRelease(ST7558_PIPE_FRAME);
+    }
+    return true;
+}
+
+/**************************************************************/
+/** @brief This method publishes a new handoff state and wakes 
+           the other side
+*/
+/**************************************************************/
+void ST7558::_pipeRelease(const uint8_t state) {   
+    
+#if defined(ESP32)
+    _pipeState.store(state, std::memory_order_release);
+    if (state == ST7558_PIPE_IDLE) {
+        TaskHandle_t waiter = _pipeWaiter;
+        if (waiter) {
+            xTaskNotifyGive(waiter);
+        }
+    } else {
+        xTaskNotifyGive(_pipeTask);
+    }
+#else
+    {
+        // the lock only orders the store against a waiter going to sleep
+        std::lock_guard<std::mutex> lock(_pipeLock);
+        _pipeState.store(state, std::memory_order_release);
+    }
+    _pipeWake.notify_all();
+#endif
+}
+
+/**************************************************************/
+/** @brief This method is the flush task: wait for a frame, send 
+           it, give the slot back
+*/
+/**************************************************************/
+void ST7558::_pipeLoop(void) {   
+    
+    for (;;) {
+
+    #if defined(ESP32)
+        while (_pipeState.load(std::memory_order_acquire) == ST7558_PIPE_IDLE) {
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        }
+    #else
+        {
+            std::unique_lock<std::mutex> lock(_pipeLock);
+            _pipeWake.wait(lock, [this] { 
+                return _pipeState.load(std::memory_order_acquire) != ST7558_PIPE_IDLE; 
+            });
+        }
+    #endif
+        if (_pipeState.load(std::memory_order_acquire) == ST7558_PIPE_STOP) {
+            return;
+        }
+        _bus.beginFrame();
+        while (_flushStep());
+        _bus.endFrame();
+        _pipeRelease(ST7558_PIPE_IDLE);
+    }
+}
+
+void ST7558::_pipeMain(void *self) {   
+    
+    ST7558 *lcd = static_cast<ST7558 *>(self);
+    lcd->_pipeLoop();
+#if defined(ESP32)
+    lcd->_pipeState.store(ST7558_PIPE_DONE, std::memory_order_release);
+    vTaskDelete(NULL);
+#endif
+}
+#endif
+
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+//                           ROTATION                           //   
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+
+/**************************************************************/
+/** @brief Turn the picture clockwise, as in Adafruit_GFX. No 
+           pixel is transformed while drawing. 180° is the 
+           controller's own X/Y mirroring. At 90° and 270° 
+           drawing goes to a canvas of the turned size (heap, 
+           ST7558_HEIGHT * ST7558_WIDTH / 8 bytes) that each 
+           flush transposes into the framebuffer 8x8 bits at a 
+           time, and the mirroring does the rest. The next flush 
+           resends the whole frame. Going between 0/180 and 
+           90/270 clears the picture. Ignored in strip mode, and 
+           if the canvas can't be allocated
+    @param  r   0 - 0°, 1 - 90°, 2 - 180°, 3 - 270°
+*/
+/**************************************************************/
+void ST7558::setRotation(uint8_t r) {
+
+#ifdef ST7558_STRIP_PAGES
+    (void)r;
+#else
+    _orient(r & 3, _flips);
+#endif
+}
+
+/**************************************************************/
+/** @brief Mirror the picture on the glass, on top of the 
+           rotation. Free, like rotation 180. Ignored in strip 
+           mode
+    @param  x   true - left and right swapped
+    @param  y   true - top and bottom swapped
+*/
+/**************************************************************/
+void ST7558::setMirror(const bool x, const bool y) {
+
+#ifdef ST7558_STRIP_PAGES
+    (void)x;
+    (void)y;
+#else
+    _orient(rotation, (x ? MIRROR_X : 0) | (y ? MIRROR_Y : 0));
+#endif
+}
+
+/**************************************************************/
+/** @brief This method applies a rotation and mirror flips. On 
+           top of the transpose at 90/270, a rotation is a flip 
+           of the glass: 90° X, 180° both, 270° Y
+    @return false if it can't be done, nothing is changed then
+*/
+/**************************************************************/
+bool ST7558::_orient(const uint8_t r, const uint8_t flips) {
+
+    static const uint8_t turn[4] = { 0, MIRROR_X, MIRROR_X | MIRROR_Y, MIRROR_Y };
+    const uint8_t glass = turn[r] ^ flips;
+    waitFlush();
+    if ((r & 1) && !_rotated) {
+
+        ST7558Canvas *canvas = new ST7558Canvas(ST7558_HEIGHT, ST7558_WIDTH);
+        if (!canvas || !canvas->getBuffer()) {
+            delete canvas;
+            return false;
+        }
+        canvas->setRasterOp(_rop);
+        _rotated = canvas;
+        _rotatedDirty = true;               // clears the framebuffer
+    } else if (!(r & 1) && _rotated) {
+
+        delete _rotated;
+        _rotated = NULL;
+        clearDisplay();
+    }
+    Adafruit_GFX::setRotation(r);
+    _flips = flips;
+    _setMirror((MIRROR_X | MIRROR_Y) ^ glass);
+    return true;
+}
+
+/**************************************************************/
+/** @brief This method queues the controller's MX/MY bits for 
+           the next transaction and moves the framebuffer in the 
+           RAM to match: a mirrored axis maps from the other end 
+           of the RAM
+*/
+/**************************************************************/
+void ST7558::_setMirror(const uint8_t bits) {
+
+    if (bits == _mirror) {
+        return;
+    }
+    _mirror = bits;
+    _columnOffset = (bits & MIRROR_X) 
+        ? ST7558_COLUMN_OFFSET 
+        : ST7558_RAM_WIDTH - ST7558_WIDTH - ST7558_COLUMN_OFFSET;
+    const uint8_t shift = (bits & MIRROR_Y) ? 0 : ST7558_MIRROR_Y_SHIFT;
+    _pageShift = shift / 8;
+    _rowShift = shift % 8;
+    _command((ST7558_EXTENDED_DISPAY_CONTROL & ~(MIRROR_X | MIRROR_Y)) | bits);
+    _markAllDirty();                        // every byte moves in the RAM
+}
+
+/**************************************************************/
+/** @brief This method copies the 90/270 canvas into the 
+           framebuffer, transposed: canvas column x becomes 
+           framebuffer row x. 8x8 blocks are transposed whole, 
+           and only bytes that differ are written and marked. 
+           Skipped while nothing was drawn, unless double 
+           buffering swapped an older frame in
+*/
+/**************************************************************/
+void ST7558::_transposeRotated(void) {
+
+    if (!_rotated || (!_rotatedDirty && _front == _buffer)) {
+        return;
+    }
+    _rotatedDirty = false;
+
+    const uint8_t *src = _rotated->getBuffer();
+    uint8_t rows[8], cols[8];
+    for (uint8_t page = 0; page < ST7558_PAGES; page++) {
+
+        uint8_t *dst = &_buffer[ST7558_WIDTH * page];
+        uint8_t changedMin = 0xFF, changedMax = 0;
+        for (uint8_t x = 0; x < ST7558_WIDTH; x += 8) {
+
+            // 8 canvas columns of one canvas page: the block's rows
+            const uint8_t *block = &src[ST7558_HEIGHT * (x / 8) + page * 8];
+            for (uint8_t j = 0; j < 8; j++) {
+                rows[j] = (page * 8 + j < ST7558_HEIGHT) ? block[j] : 0;
+            }
+            // transpose8() reads its rows MSB left: bit k is column 7 - k
+            ST7558Raster::transpose8(rows, cols);
+
+            for (uint8_t k = 0; k < 8 && x + k < ST7558_WIDTH; k++) {
+
+                if (dst[x + k] != cols[7 - k]) {
+                    dst[x + k] = cols[7 - k];
+                    if (changedMin == 0xFF) {
+                        changedMin = x + k;
+                    }
+                    changedMax = x + k;
+                }
+            }
+        }
+        if (changedMin != 0xFF) {
+            _markDirty(page, changedMin, changedMax);
+            _markInk(page, changedMin, changedMax);
+        }
+    }
+}
+
+
+#ifdef ST7558_ENABLE_RECORDER
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+//                        FRAME RECORDER                        //   
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+
+/**************************************************************/
+/** @brief Log every frame flushed from now on to 'sink', as 
+           XOR deltas run-length coded (format in ST7558Delta.h). Each 
+           flush walks only the spans it sends, so the cost 
+           follows the change, and a flush that changes nothing 
+           records nothing. Decode with extras/host/player
+    @param  sink        e.g. Serial or an SD file
+    @param  reference   getBufferSize() bytes the recorder keeps 
+                        the last frame in
+*/
+/**************************************************************/
+void ST7558::startRecording(Print &sink, uint8_t *reference) {
+
+    _recSink = &sink;
+    _recReference = reference;
+    _recFrames = 0;
+    _recKey = true;
+    memset(reference, 0, ST7558_BUFFER_SIZE);
+    ST7558DeltaWriter::header(sink, ST7558_WIDTH, ST7558_HEIGHT);
+}
+
+void ST7558::stopRecording(void) {
+
+    _recSink = NULL;
+}
+
+/**************************************************************/
+/** @brief This method records the frame a flush is about to 
+           send: the bytes of its spans, against the reference. 
+           The first frame is walked whole, as a key frame
+*/
+/**************************************************************/
+void ST7558::_recordFrame(void) {
+
+    if (!_recSink) {
+        return;
+    }
+    const uint16_t index = _recFrames++;    // skipped numbers are idle flushes
+    bool changed = _recKey;
+    for (uint8_t page = 0; page < ST7558_PAGES && !changed; page++) {
+        changed = _flushPage[page].min <= _flushPage[page].max;
+    }
+    if (!changed) {
+        return;
+    }
+
+    ST7558DeltaWriter out(*_recSink, _recKey ? ST7558_REC_KEY : ST7558_REC_FRAME, 
+                          index, millis());
+    for (uint8_t page = 0; page < ST7558_PAGES; page++) {
+
+        uint8_t from = 0, x0, x1;
+        for (;;) {
+
+            if (_recKey) {
+                if (from) {
+                    break;
+                }
+                x0 = 0;
+                x1 = ST7558_WIDTH - 1;
+            } else if (!_nextSpan(_flushPage[page], from, x0, x1)) {
+                break;
+            }
+            from = x1 + 1;
+            out.code(_flushSource, _flushProgmem, _recReference, 
+                     ST7558_WIDTH * page + x0, ST7558_WIDTH * page + x1);
+        }
+    }
+    out.finish(_recKey);
+    _recKey = false;
+}
+#endif
+
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+//                     FEEDBACK FUNCTIONS                       //   
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+
+uint8_t ST7558::getPixel(const uint8_t x, const uint8_t y) {
+
+    if (_rotated) {
+        return _rotated->getPixel(x, y);
+    }
+    if (x < ST7558_WIDTH && y >= ST7558_CLIP_TOP && y < ST7558_CLIP_BOTTOM) {
+        return (_buffer[x + (y/8 - ST7558_CLIP_FIRST) * ST7558_WIDTH] >> y%8) & 1;
+    }
+    return 0;
+}
+
+/**************************************************************/
+/** @brief Get the bus backend, e.g. to read its counters
+    @return Reference to the transport the driver writes to
+*/
+/**************************************************************/
+ST7558Bus &ST7558::getBus(void) { 
+    return _bus; 
+}
+
+#ifdef ST7558_ENABLE_STATS
+/**************************************************************/
+/** @brief Get the counters kept since begin() or resetStats()
+*/
+/**************************************************************/
+const ST7558Stats &ST7558::getStats(void) { 
+    return _stats; 
+}
+
+/**************************************************************/
+/** @brief Zero all counters
+*/
+/**************************************************************/
+void ST7558::resetStats(void) { 
+    
+    memset(&_stats, 0, sizeof(_stats));
+    _stats.flushMinUs = 0xFFFFFFFF;
+}
+
+/**************************************************************/
+/** @brief Print the counters as three short lines, e.g. to 
+           Serial:
+           
+           i2c tx=28 data=864 ovh=31
+           flush n=1 idle=0 sent=864 skip=0 us=836/836/836
+           draw px=0 fill=1 blit=0 chr=0
+*/
+/**************************************************************/
+void ST7558::printStats(Print &out) { 
+    
+    out.print(F("i2c tx="));
+    out.print(_stats.transactions);
+    out.print(F(" data="));
+    out.print(_stats.payloadBytes);
+    out.print(F(" ovh="));
+    out.println(_stats.overheadBytes);
+
+    out.print(F("flush n="));
+    out.print(_stats.flushes);
+    out.print(F(" idle="));
+    out.print(_stats.idleFlushes);
+    out.print(F(" sent="));
+    out.print(_stats.sentBytes);
+    out.print(F(" skip="));
+    out.print(_stats.skippedBytes);
+    out.print(F(" us="));
+    out.print(_stats.flushes ? _stats.flushMinUs : 0);
+    out.print('/');
+    out.print(_stats.flushes ? _stats.flushTotalUs / _stats.flushes : 0);
+    out.print('/');
+    out.println(_stats.flushMaxUs);
+
+    out.print(F("draw px="));
+    out.print(_stats.pixels);
+    out.print(F(" fill="));
+    out.print(_stats.fills);
+    out.print(F(" blit="));
+    out.print(_stats.blits);
+    out.print(F(" chr="));
+    out.println(_stats.chars);
+}
+
+/**************************************************************/
+/** @brief This method books a finished flush: its duration 
+           (min/avg/max) and the framebuffer bytes it sent or 
+           left out. Vertical blocks also send clean bytes, so 
+           sent bytes may exceed the framebuffer
+*/
+/**************************************************************/
+void ST7558::_statsFlushDone(void) { 
+    
+    if (!_flushBytes) {
+        _stats.idleFlushes++;
+        return;
+    }
+
+    const uint32_t us = micros() - _flushStarted;
+    _stats.flushes++;
+    _stats.flushTotalUs += us;
+    if (us < _stats.flushMinUs) {
+        _stats.flushMinUs = us;
+    }
+    if (us > _stats.flushMaxUs) {
+        _stats.flushMaxUs = us;
+    }
+    _stats.sentBytes += _flushBytes;
+    if (_flushBytes < ST7558_BUFFER_SIZE) {
+        _stats.skippedBytes += ST7558_BUFFER_SIZE - _flushBytes;
+    }
+}
+#endif
+
+/**************************************************************/
+/** @brief Get memory pointer to the framebuffer. The driver 
+           can't see writes through it, so the whole framebuffer 
+           is treated as changed
+    @return Pointer to the first framebuffer's element 
+*/
+/**************************************************************/
+uint8_t *ST7558::getBuffer(void) { 
+    _markAllDirty();
+    return _buffer; 
+}
+
+#ifndef ST7558_STRIP_PAGES
+/**************************************************************/
+/** @brief Draw into a caller-owned page-major buffer of 
+           getBufferSize() bytes instead of the built-in one. 
+           Nothing is copied, the buffer is sent in full by the 
+           next flush
+    @param  buffer  new framebuffer, NULL - the built-in one
+*/
+/**************************************************************/
+void ST7558::attachBuffer(uint8_t *buffer) {
+    
+    const bool single = _front == _buffer;
+
+    waitFlush();
+    _buffer = buffer ? buffer : _storage;
+    if (single) {
+        _front = _buffer;
+    }
+    _markAllDirty();
+}
+
+/**************************************************************/
+/** @brief Turn on double buffering with a caller-owned back 
+           buffer of getBufferSize() bytes. Drawing goes to the 
+           back buffer, and each flush swaps it with the shown 
+           one in O(1). After a swap the draw target holds the 
+           frame before the one just shown
+    @param  buffer  back buffer, NULL - single buffering
+*/
+/**************************************************************/
+void ST7558::setBackBuffer(uint8_t *buffer) {
+    
+    waitFlush();
+    if (_front != _buffer) {
+
+        // back to one buffer, keeping the shown frame out of the old 
+        // back buffer: the caller may free or reuse it
+        uint8_t *own = _front == _back ? _buffer : _front;
+        if (own != _front) {
+            memcpy(own, _front, ST7558_STORAGE_SIZE);
+        }
+        _buffer = _front = own;
+    }
+    if (buffer) {
+
+        for (uint8_t page = 0; page < ST7558_PAGES; page++) {
+
+            PageState &ps = _page[page];
+            ps.otherInkMin = ps.inkMin;
+            ps.otherInkMax = ps.inkMax;
+            ps.prevDirty.min = 0xFF;
+            ps.prevDirty.max = 0;
+            ps.prevDirty.mask = 0;
+        }
+        _buffer = buffer;
+    }
+    _back = buffer;
+    _markAllDirty();
+}
+#endif
+
+/**************************************************************/
+/** @brief Get size of the framebuffer in bytes
+    @return Size in bytes
+*/
+/**************************************************************/
+uint16_t ST7558::getBufferSize(void) {
+    return ST7558_STORAGE_SIZE; 
+}
+
+#ifndef ST7558_STRIP_PAGES
+/***************************************************************/
+/** @brief Push another buffer
+*/
+/***************************************************************/
+void ST7558::pushBuffer(uint8_t *buffer, const uint16_t size) { 
+    memmove(_buffer, buffer, size); 
+    _markAllDirty();
+}
+#endif
+
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+//                      DRAWING FUNCTIONS                       //   
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+
+/****************************************************************/
+/** @brief  Set how colors combine with the framebuffer in every 
+            draw function (pixels, lines, fills, text, bitmaps), 
+            e.g. ST7558_ROP_XOR to toggle a highlight in place and 
+            draw it again to remove it. blit() takes its own op. 
+            INVERSE flips pixels in any mode
+    @param  op  ST7558_ROP_COPY (default): BLACK sets, WHITE clears
+                ST7558_ROP_OR: only BLACK draws
+                ST7558_ROP_AND: only WHITE draws
+                ST7558_ROP_XOR: BLACK flips, WHITE does nothing
+                ST7558_ROP_NOT: BLACK clears, WHITE sets
+*/
+/****************************************************************/
+void ST7558::setRasterOp(ST7558RasterOp op) {
+
+    _rop = op;
+    if (_rotated) {
+        _rotated->setRasterOp(op);
+    }
+}
+
+ST7558RasterOp ST7558::getRasterOp(void) {
+    return _rop;
+}
+
+/****************************************************************/
+/** @brief  This method turns a color into what it does to the 
+            pixels drawn, under the current raster op
+*/
+/****************************************************************/
+uint8_t ST7558::_action(const uint16_t color) {
+    return ST7558Raster::action(color, _rop);
+}
+
+/****************************************************************/
+/** @brief  This method picks the blit op for drawing a color on 
+            the set bits of a source, or on its clear bits with 
+            background set
+    @return false if the color leaves the pixels as they are
+*/
+/****************************************************************/
+bool ST7558::_colorOp(const uint16_t color, const bool background, 
+                      ST7558RasterOp &op, bool &invert) {
+    return ST7558Raster::colorOp(_action(color), background, op, invert);
+}
+
+/****************************************************************/
+/** @brief  Draw one pixel to the framebuffer
+    @param  x   x coordinate
+    @param  y   y coordinate
+    @param  color 
+*/
+/****************************************************************/
+void ST7558::drawPixel (int16_t x, int16_t y, 
+                     uint16_t color) {
+
+    ST7558_STAT(_stats.pixels++);
+    if (_rotated) {
+        _rotated->drawPixel(x, y, color);
+        _rotatedDirty = true;
+        return;
+    }
+    if ((x >= 0 && x < ST7558_WIDTH) 
+    && (y >= ST7558_CLIP_TOP && y < ST7558_CLIP_BOTTOM)) {
+
+        const uint8_t action = _action(color);
+        if (action == ST7558_DRAW_NONE) {
+            return;
+        }
+        const uint8_t page = y/8;
+        PageState &ps = _page[page];
+        DirtySpan &dirty = ps.dirty;
+        uint8_t &byte = _buffer[x + (page - ST7558_CLIP_FIRST) * ST7558_WIDTH];
+        if (action == ST7558_DRAW_CLEAR) {
+            byte &= ~(1 << y%8);
+        } else {
+
+            if (action == ST7558_DRAW_SET) {
+                byte |= (1 << y%8);
+            } else {
+                byte ^= (1 << y%8);
+            }
+            if (x < ps.inkMin) {
+                ps.inkMin = x;
+            }
+            if (x > ps.inkMax) {
+                ps.inkMax = x;
+            }
+        }
+        if (x < dirty.min) {
+            dirty.min = x;
+        }
+        if (x > dirty.max) {
+            dirty.max = x;
+        }
+        dirty.mask |= 1U << (x / ST7558_DIRTY_BLOCK);
+    }
+}
+
+/****************************************************************/
+/** @brief  Draw rectangle to the framebuffer
+    @param  x   x coordinate
+    @param  y   y coordinate
     @param  w   rectangle width
     @param  h   rectangle height
     @param  color 
@@ -358,21 +2141,72 @@ void ST7558::drawPixel (int16_t x, int16_t y,
 void ST7558::drawRect(int16_t x, int16_t y, 
                       int16_t w, int16_t h, 
                       uint16_t color) {
-    
-    for (int i = x; i < w+x; i++) {
 
-        drawPixel(i, y, color);
-        drawPixel(i, y+h-1, color);
-    }
-    for (int i = y; i < h+y; i++) {
+    ST7558Raster::rect(x, y, w, h, [this, color](int16_t fx, int16_t fy, int16_t fw, int16_t fh) {
+        fillRect(fx, fy, fw, fh, color);
+    });
+}
+
+/****************************************************************/
+/** @brief  Draw a rectangle with rounded corners, each pixel 
+            once, see ST7558Raster::roundRect()
+    @param  x   x coordinate
+    @param  y   y coordinate
+    @param  w   rectangle width
+    @param  h   rectangle height
+    @param  r   corner radius
+    @param  color 
+*/
+/****************************************************************/
+void ST7558::drawRoundRect(int16_t x, int16_t y, 
+                           int16_t w, int16_t h, 
+                           int16_t r, uint16_t color) {
+
+    ST7558Raster::roundRect(x, y, w, h, r,
+        [this, color](int16_t fx, int16_t fy, int16_t fw, int16_t fh) {
+            fillRect(fx, fy, fw, fh, color);
+        },
+        [this, color](int16_t px, int16_t py) {
+            drawPixel(px, py, color);
+        });
+}
+
+/****************************************************************/
+/** @brief  Draw a filled rectangle with rounded corners, as 
+            Adafruit_GFX does, see 
+            ST7558Raster::filledRoundRectIsRect()
+*/
+/****************************************************************/
+void ST7558::fillRoundRect(int16_t x, int16_t y, 
+                           int16_t w, int16_t h, 
+                           int16_t r, uint16_t color) {
 
-        drawPixel(x, i, color);
-        drawPixel(x+w-1, i, color);
+    if (ST7558Raster::filledRoundRectIsRect(w, h, r)) {
+        fillRect(x, y, w, h, color);
+        return;
     }
+    Adafruit_GFX::fillRoundRect(x, y, w, h, r, color);
+}
+
+/****************************************************************/
+/** @brief  Draw a circle outline, each pixel once
+    @param  x0  center x coordinate
+    @param  y0  center y coordinate
+    @param  r   radius
+    @param  color 
+*/
+/****************************************************************/
+void ST7558::drawCircle(int16_t x0, int16_t y0, 
+                        int16_t r, uint16_t color) {
+
+    ST7558Raster::circle(x0, y0, r, [this, color](int16_t px, int16_t py) {
+        drawPixel(px, py, color);
+    });
 }
 
 /****************************************************************/
-/** @brief  Draw a filled rectangle to the framebuffer
+/** @brief  Draw a filled rectangle to the framebuffer. Clipped 
+            once, then filled page by page with byte masks
     @param  x   x coordinate
     @param  y   y coordinate
     @param  w   rectangle width
@@ -384,13 +2218,474 @@ void ST7558::fillRect(int16_t x, int16_t y,
                       int16_t w, int16_t h, 
                       uint16_t color) {
 
-    for (int i = y; i < h+y; i++) {
+    if (w <= 0 || h <= 0) {
+        return;
+    }
+    if (_rotated) {
+        _rotated->fillRect(x, y, w, h, color);
+        _rotatedDirty = true;
+        return;
+    }
+
+    int16_t x1 = x + w - 1;
+    int16_t y1 = y + h - 1;
+    if (x < 0) {
+        x = 0;
+    }
+    if (y < ST7558_CLIP_TOP) {
+        y = ST7558_CLIP_TOP;
+    }
+    if (x1 >= ST7558_WIDTH) {
+        x1 = ST7558_WIDTH - 1;
+    }
+    if (y1 >= ST7558_CLIP_BOTTOM) {
+        y1 = ST7558_CLIP_BOTTOM - 1;
+    }
+    if (x <= x1 && y <= y1) {
+        _fillArea(x, x1, y, y1, color);
+    }
+}
+
+/****************************************************************/
+/** @brief  Draw a horizontal line to the framebuffer
+    @param  x   x coordinate of the left end
+    @param  y   y coordinate
+    @param  w   line width
+    @param  color 
+*/
+/****************************************************************/
+void ST7558::drawFastHLine(int16_t x, int16_t y, 
+                           int16_t w, uint16_t color) {
+    fillRect(x, y, w, 1, color);
+}
+
+/****************************************************************/
+/** @brief  Draw a vertical line to the framebuffer
+    @param  x   x coordinate
+    @param  y   y coordinate of the top end
+    @param  h   line height
+    @param  color 
+*/
+/****************************************************************/
+void ST7558::drawFastVLine(int16_t x, int16_t y, 
+                           int16_t h, uint16_t color) {
+    fillRect(x, y, 1, h, color);
+}
+
+/****************************************************************/
+/** @brief  Adafruit_GFX batched-write hooks, used by circles, 
+            round rects, triangles and text. Same as the draw 
+            versions, without one more virtual call
+*/
+/****************************************************************/
+void ST7558::writeFillRect(int16_t x, int16_t y, 
+                           int16_t w, int16_t h, 
+                           uint16_t color) {
+    ST7558::fillRect(x, y, w, h, color);
+}
+
+void ST7558::writeFastHLine(int16_t x, int16_t y, 
+                            int16_t w, uint16_t color) {
+    ST7558::fillRect(x, y, w, 1, color);
+}
+
+void ST7558::writeFastVLine(int16_t x, int16_t y, 
+                            int16_t h, uint16_t color) {
+    ST7558::fillRect(x, y, 1, h, color);
+}
+
+/****************************************************************/
+/** @brief  This method fills an already clipped area, see 
+            ST7558Raster::fill()
+*/
+/****************************************************************/
+void ST7558::_fillArea(const uint8_t x0, const uint8_t x1, 
+                       const uint8_t y0, const uint8_t y1, 
+                       const uint16_t color) {
+
+    ST7558_STAT(_stats.fills++);
+    const uint8_t action = _action(color);
+    if (action != ST7558_DRAW_NONE) {
+        ST7558Raster::fill(_buffer, ST7558_WIDTH, ST7558_CLIP_FIRST, x0, x1, y0, y1, 
+                           action, Marker(*this));
+    }
+}
+
+/****************************************************************/
+/** @brief  Draw a page-major bitmap, the controller's own format: 
+            (h + 7) / 8 pages of w bytes, one byte per column, 
+            LSB on top. Any y is allowed, each source byte is 
+            shifted across two framebuffer pages
+    @param  x   x coordinate
+    @param  y   y coordinate
+    @param  bitmap  bitmap in PROGMEM
+    @param  w   bitmap width
+    @param  h   bitmap height
+    @param  op  raster op, see ST7558RasterOp
+    @param  mask    optional transparency mask in the same format, 
+                    pixels with a clear mask bit are left untouched
+*/
+/****************************************************************/
+void ST7558::blit(int16_t x, int16_t y, const uint8_t *bitmap, 
+                  uint8_t w, uint8_t h, 
+                  ST7558RasterOp op, const uint8_t *mask) {
+    ST7558_STAT(_stats.blits++);
+    _blit(x, y, bitmap, w, h, op, mask, true, false);
+}
+
+/****************************************************************/
+/** @brief  Same as above, with the bitmap and mask in RAM
+*/
+/****************************************************************/
+void ST7558::blit(int16_t x, int16_t y, uint8_t *bitmap, 
+                  uint8_t w, uint8_t h, 
+                  ST7558RasterOp op, uint8_t *mask) {
+    ST7558_STAT(_stats.blits++);
+    _blit(x, y, bitmap, w, h, op, mask, false, false);
+}
+
+/****************************************************************/
+/** @brief  Blit an off-screen canvas. It is already page-major, 
+            so this is the same shifted copy as above, with no 
+            conversion
+    @param  x   x coordinate
+    @param  y   y coordinate
+    @param  canvas  source canvas
+    @param  op  raster op, see ST7558RasterOp
+*/
+/****************************************************************/
+void ST7558::blit(int16_t x, int16_t y, ST7558Canvas &canvas, 
+                  ST7558RasterOp op) {
+
+    ST7558_STAT(_stats.blits++);
+    if (canvas.getBuffer()) {
+        _blit(x, y, canvas.getBuffer(), canvas.width(), canvas.height(), op, NULL, false, false);
+    }
+}
+
+/****************************************************************/
+/** @brief  Draw an Adafruit_GFX (row-major, MSB left) bitmap. 
+            Each 8x8 block is transposed to column bytes and 
+            blitted, instead of one drawPixel per bit
+*/
+/****************************************************************/
+void ST7558::drawBitmap(int16_t x, int16_t y, const uint8_t bitmap[], 
+                        int16_t w, int16_t h, uint16_t color) {
+
+    ST7558RasterOp op;
+    bool invert;
+    if (_colorOp(color, false, op, invert)) {
+        _drawRowMajor(x, y, bitmap, w, h, op, true, invert);
+    }
+}
+
+void ST7558::drawBitmap(int16_t x, int16_t y, const uint8_t bitmap[], 
+                        int16_t w, int16_t h, uint16_t color, 
+                        uint16_t bg) {
+
+    const uint8_t fgAction = _action(color);
+    const uint8_t bgAction = _action(bg);
+    const bool copy = ST7558Raster::isCopy(fgAction, bgAction);
+    ST7558RasterOp op;
+    bool invert;
+    if (fgAction == bgAction) {
+        fillRect(x, y, w, h, color);
+    } else if (copy) {
+        _drawRowMajor(x, y, bitmap, w, h, ST7558_ROP_COPY, true, fgAction == ST7558_DRAW_CLEAR);
+    } else {
+        if (_colorOp(color, false, op, invert)) {
+            _drawRowMajor(x, y, bitmap, w, h, op, true, invert);
+        }
+        if (_colorOp(bg, true, op, invert)) {
+            _drawRowMajor(x, y, bitmap, w, h, op, true, invert);
+        }
+    }
+}
+
+void ST7558::drawBitmap(int16_t x, int16_t y, uint8_t *bitmap, 
+                        int16_t w, int16_t h, uint16_t color) {
+
+    ST7558RasterOp op;
+    bool invert;
+    if (_colorOp(color, false, op, invert)) {
+        _drawRowMajor(x, y, bitmap, w, h, op, false, invert);
+    }
+}
+
+void ST7558::drawBitmap(int16_t x, int16_t y, uint8_t *bitmap, 
+                        int16_t w, int16_t h, uint16_t color, 
+                        uint16_t bg) {
+
+    const uint8_t fgAction = _action(color);
+    const uint8_t bgAction = _action(bg);
+    const bool copy = ST7558Raster::isCopy(fgAction, bgAction);
+    ST7558RasterOp op;
+    bool invert;
+    if (fgAction == bgAction) {
+        fillRect(x, y, w, h, color);
+    } else if (copy) {
+        _drawRowMajor(x, y, bitmap, w, h, ST7558_ROP_COPY, false, fgAction == ST7558_DRAW_CLEAR);
+    } else {
+        if (_colorOp(color, false, op, invert)) {
+            _drawRowMajor(x, y, bitmap, w, h, op, false, invert);
+        }
+        if (_colorOp(bg, true, op, invert)) {
+            _drawRowMajor(x, y, bitmap, w, h, op, false, invert);
+        }
+    }
+}
+
+/****************************************************************/
+/** @brief  One-time conversion of an Adafruit_GFX bitmap (in 
+            PROGMEM) to the page-major format used by blit()
+    @param  bitmap  row-major bitmap in PROGMEM
+    @param  w   bitmap width
+    @param  h   bitmap height
+    @param  out     w * ((h + 7) / 8) bytes
+*/
+/****************************************************************/
+void ST7558::toPageMajor(const uint8_t *bitmap, uint8_t w, 
+                         uint8_t h, uint8_t *out) {
+    ST7558Raster::toPageMajor(bitmap, w, h, out, true);
+}
+
+/****************************************************************/
+/** @brief  Same as above, with the bitmap in RAM, e.g. the 
+            buffer of a GFXcanvas1
+*/
+/****************************************************************/
+void ST7558::toPageMajor(uint8_t *bitmap, uint8_t w, 
+                         uint8_t h, uint8_t *out) {
+    ST7558Raster::toPageMajor(bitmap, w, h, out, false);
+}
+
+/****************************************************************/
+/** @brief  This method draws a row-major bitmap as a grid of 
+            transposed 8x8 blocks. Blocks outside the screen are 
+            skipped before they are read
+*/
+/****************************************************************/
+void ST7558::_drawRowMajor(int16_t x, int16_t y, const uint8_t *bitmap, 
+                           int16_t w, int16_t h, const ST7558RasterOp op, 
+                           const bool progmem, const bool invert) {
+
+    ST7558_STAT(_stats.blits++);
+    if (_rotated) {
+        _rotated->_drawRowMajor(x, y, bitmap, w, h, op, progmem, invert);
+        _rotatedDirty = true;
+        return;
+    }
+    ST7558Raster::rowMajor(x, y, bitmap, w, h, progmem, ST7558_WIDTH, 
+                           ST7558_CLIP_TOP, ST7558_CLIP_BOTTOM, 
+                           [this, op, invert](int16_t bx, int16_t by, const uint8_t *cols, 
+                                              uint8_t bw, uint8_t bh) {
+        _blit(bx, by, cols, bw, bh, op, NULL, false, invert);
+    });
+}
+
+/****************************************************************/
+/** @brief  Draw a character. Unscaled glyphs are written as 
+            column bytes straight into the framebuffer instead of 
+            one drawPixel per font pixel; scaled ones go through 
+            Adafruit_GFX, which already uses fillRect for them
+    @param  x   x coordinate
+    @param  y   y coordinate
+    @param  c   character
+    @param  color 
+    @param  bg  background color, same as color for transparent text
+    @param  size_x  horizontal scale
+    @param  size_y  vertical scale
+*/
+/****************************************************************/
+void ST7558::drawChar(int16_t x, int16_t y, unsigned char c, 
+                      uint16_t color, uint16_t bg, 
+                      uint8_t size_x, uint8_t size_y) {
+
+    ST7558_STAT(_stats.chars++);
+    if (size_x == 1 && size_y == 1) {
+
+        if (gfxFont) {
+            if (_drawFontChar(x, y, c, color)) {
+                return;
+            }
+        } else {
+#ifndef ST7558_NO_GLCDFONT
+            if (!_rotated && (x >= ST7558_WIDTH || y >= ST7558_CLIP_BOTTOM || 
+                              x + 5 < 0 || y + 7 < ST7558_CLIP_TOP)) {
+                return;
+            }
+            uint8_t cols[6];
+            ST7558Raster::glyph(c, _cp437, cols);
+            _drawGlyph(x, y, cols, color, bg);
+            return;
+#endif
+        }
+    }
+    Adafruit_GFX::drawChar(x, y, c, color, bg, size_x, size_y);
+}
+
+/****************************************************************/
+/** @brief  Redefine a write method for Print.h. Same cursor and 
+            wrap rules as Adafruit_GFX, without the virtual 
+            drawChar call for the classic font
+    @param  c   input char
+*/
+/****************************************************************/
+size_t ST7558::write(uint8_t c) {
+
+    if (gfxFont) {
+        return Adafruit_GFX::write(c);
+    }
+
+    if (c == '\n') {
+        cursor_x = 0;
+        cursor_y += textsize_y * 8;
+    } else if (c != '\r') {
+        if (wrap && (cursor_x + textsize_x * 6 > _width)) {
+            cursor_x = 0;
+            cursor_y += textsize_y * 8;
+        }
+        ST7558::drawChar(cursor_x, cursor_y, c, textcolor, textbgcolor, 
+                         textsize_x, textsize_y);
+        cursor_x += textsize_x * 6;
+    }
+    return 1; // for compatibility with Print.h
+}
+
+/****************************************************************/
+/** @brief  This method draws a 6x8 classic glyph given as column 
+            bytes, see ST7558Raster::text(). Opaque text in COPY 
+            mode is one store per column, with no clear pass
+*/
+/****************************************************************/
+void ST7558::_drawGlyph(int16_t x, int16_t y, const uint8_t *cols, 
+                        uint16_t color, uint16_t bg) {
+
+    ST7558Raster::text(_action(color), _action(bg), bg != color,
+        [this, x, y, color]() {
+            fillRect(x, y, 6, 8, color);
+        },
+        [this, x, y, cols](uint8_t w, ST7558RasterOp op, bool invert) {
+            _drawColumns(x, y, cols, w, op, invert);
+        });
+}
+
+/****************************************************************/
+/** @brief  This method writes up to 6 glyph columns. At 
+            page-aligned y they land on whole framebuffer bytes 
+            and skip the shifting blit
+*/
+/****************************************************************/
+void ST7558::_drawColumns(int16_t x, int16_t y, const uint8_t *cols, 
+                          const uint8_t w, const ST7558RasterOp op, 
+                          const bool invert) {
+
+    if (!(y & 7) && y >= ST7558_CLIP_TOP && y + 8 <= ST7558_CLIP_BOTTOM 
+        && x >= 0 && x + w <= ST7558_WIDTH && !_rotated) {
+
+        const uint8_t page = y / 8;
+        uint8_t *dst = &_buffer[ST7558_WIDTH * (page - ST7558_CLIP_FIRST) + x];
+        uint8_t changedMin = 0xFF, changedMax = 0;
+        for (uint8_t i = 0; i < w; i++) {
+
+            const uint8_t s = invert ? ~cols[i] : cols[i];
+            uint8_t d = dst[i];
+            switch (op) {
+                case ST7558_ROP_COPY: d = s; break;
+                case ST7558_ROP_OR:   d |= s; break;
+                case ST7558_ROP_AND:  d &= s; break;
+                case ST7558_ROP_XOR:  d ^= s; break;
+                case ST7558_ROP_NOT:  d = ~s; break;
+            }
+            if (d != dst[i]) {
+                dst[i] = d;
+                if (changedMin == 0xFF) {
+                    changedMin = i;
+                }
+                changedMax = i;
+            }
+        }
+        if (changedMin != 0xFF) {
+            _markDirty(page, x + changedMin, x + changedMax);
+            if (op != ST7558_ROP_AND) {
+                _markInk(page, x + changedMin, x + changedMax);
+            }
+        }
+        return;
+    }
+    _blit(x, y, cols, w, 8, op, NULL, false, invert);
+}
 
-        for (int j = x; j < w+x; j++) {
+/****************************************************************/
+/** @brief  This method draws an unscaled GFXfont glyph. Its bit 
+            stream is unpacked into column bytes, eight rows at a 
+            time, and each band is blitted. Like Adafruit_GFX, 
+            custom fonts are always drawn transparent
+    @return false if the glyph is too wide for the column buffer
+*/
+/****************************************************************/
+bool ST7558::_drawFontChar(int16_t x, int16_t y, unsigned char c, 
+                           uint16_t color) {
+
+    c -= (uint8_t)pgm_read_byte(&gfxFont->first);
+    const GFXglyph *glyph = &((GFXglyph *)pgm_read_pointer(&gfxFont->glyph))[c];
+    const uint8_t *bitmap = (const uint8_t *)pgm_read_pointer(&gfxFont->bitmap);
+
+    uint16_t bo = pgm_read_word(&glyph->bitmapOffset);
+    const uint8_t w = pgm_read_byte(&glyph->width);
+    const uint8_t h = pgm_read_byte(&glyph->height);
+    const int8_t xo = pgm_read_byte(&glyph->xOffset);
+    const int8_t yo = pgm_read_byte(&glyph->yOffset);
+    if (w > ST7558_WIDTH) {
+        return false;
+    }
+    ST7558RasterOp op;
+    bool invert;
+    if (!_colorOp(color, false, op, invert)) {
+        return true;
+    }
 
-            drawPixel(j, i, color);
+    uint8_t cols[ST7558_WIDTH];
+    uint8_t bits = 0, bit = 0;
+    for (uint8_t yy = 0; yy < h; yy += 8) {
+
+        const uint8_t n = (h - yy < 8) ? h - yy : 8;
+        memset(cols, 0, w);
+        for (uint8_t j = 0; j < n; j++) {
+            for (uint8_t xx = 0; xx < w; xx++) {
+
+                if (!(bit++ & 7)) {
+                    bits = pgm_read_byte(&bitmap[bo++]);
+                }
+                if (bits & 0x80) {
+                    cols[xx] |= 1 << j;
+                }
+                bits <<= 1;
+            }
         }
+        _blit(x + xo, y + yo + yy, cols, w, n, op, NULL, false, invert);
+    }
+    return true;
+}
+
+/****************************************************************/
+/** @brief  This method does the actual blit, see 
+            ST7558Raster::blit(). Only columns that really changed 
+            are marked dirty
+*/
+/****************************************************************/
+void ST7558::_blit(int16_t x, int16_t y, const uint8_t *bitmap, 
+                   const uint8_t w, const uint8_t h, const ST7558RasterOp op, 
+                   const uint8_t *mask, const bool progmem, const bool invert) {
+
+    if (_rotated) {
+        _rotated->_blit(x, y, bitmap, w, h, op, mask, progmem, invert);
+        _rotatedDirty = true;
+        return;
     }
+    ST7558Raster::blit(_buffer, ST7558_WIDTH, ST7558_CLIP_FIRST, ST7558_CLIP_LAST, 
+                       ST7558_HEIGHT, x, y, bitmap, w, h, op, mask, progmem, invert, 
+                       Marker(*this));
 }
 
 /****************************************************************/
@@ -424,8 +2719,94 @@ void ST7558::fillSquare(int16_t x, int16_t y,
 */
 /***************************************************************/
 void ST7558::fillScreen(int16_t color) {
-     memset(_buffer, color ? 0xFF : 0x00, ST7558_BYTES_CAPACITY); 
+
+    if (_rotated) {
+        _rotated->fillScreen(color);
+        _rotatedDirty = true;
+        return;
+    }
+    const uint8_t action = _action(color);
+    if (action == ST7558_DRAW_NONE) {
+        return;
+    }
+    if (action == ST7558_DRAW_FLIP) {
+        for (uint16_t i = 0; i < ST7558_STORAGE_SIZE; i++) {
+            _buffer[i] ^= 0xFF;
+        }
+    } else {
+        memset(_buffer, action == ST7558_DRAW_SET ? 0xFF : 0x00, ST7558_STORAGE_SIZE); 
+    }
+    for (uint8_t page = 0; page < ST7558_PAGES; page++) {
+        _markDirty(page, 0, ST7558_WIDTH - 1);
+        _page[page].inkMin = action != ST7558_DRAW_CLEAR ? 0 : 0xFF;
+        _page[page].inkMax = action != ST7558_DRAW_CLEAR ? ST7558_WIDTH - 1 : 0;
+    }
+}
+
+#ifndef ST7558_STRIP_PAGES
+/***************************************************************/
+/** @brief  Shift an area of the framebuffer in place, e.g. to 
+            scroll a log up one text line and print only the new 
+            one. Pixels shifted out of the area are lost, the 
+            strip it exposes is filled. Works on whole bytes, 
+            nothing is redrawn. The raster op is ignored
+    @param  x   x coordinate of the area
+    @param  y   y coordinate of the area
+    @param  w   area width
+    @param  h   area height
+    @param  dx  columns to the right, negative to the left
+    @param  dy  rows down, negative up
+    @param  color   of the exposed strip, BLACK or WHITE
+*/
+/***************************************************************/
+void ST7558::scroll(int16_t x, int16_t y, int16_t w, int16_t h, 
+                    int16_t dx, int16_t dy, uint16_t color) {
+
+    if (w <= 0 || h <= 0 || (!dx && !dy)) {
+        return;
+    }
+    if (_rotated) {
+        _rotated->scroll(x, y, w, h, dx, dy, color);
+        _rotatedDirty = true;
+        return;
+    }
+
+    int16_t x1 = x + w - 1;
+    int16_t y1 = y + h - 1;
+    if (x < 0) {
+        x = 0;
+    }
+    if (y < 0) {
+        y = 0;
+    }
+    if (x1 >= ST7558_WIDTH) {
+        x1 = ST7558_WIDTH - 1;
+    }
+    if (y1 >= ST7558_HEIGHT) {
+        y1 = ST7558_HEIGHT - 1;
+    }
+    if (x <= x1 && y <= y1) {
+        ST7558Raster::scroll(_buffer, ST7558_WIDTH, x, x1, y, y1, dx, dy, 
+                             color == BLACK ? 0xFF : 0x00, Marker(*this));
+    }
+}
+
+/***************************************************************/
+/** @brief  Shift the whole picture sideways, see scroll()
+*/
+/***************************************************************/
+void ST7558::scrollX(int16_t dx, uint16_t color) {
+    scroll(0, 0, _width, _height, dx, 0, color);
+}
+
+/***************************************************************/
+/** @brief  Shift the whole picture up or down, see scroll()
+*/
+/***************************************************************/
+void ST7558::scrollY(int16_t dy, uint16_t color) {
+    scroll(0, 0, _width, _height, 0, dy, color);
 }
+#endif
 
 
 // old code
@@ -48,17 +48,143 @@
     #include "WProgram.h"
 #endif
 #include <Adafruit_GFX.h>
+#include "ST7558Transport.h"
+#include "ST7558Raster.h"
+#include "ST7558Delta.h"
 
-#define ST7558_WIDTH    96  
-#define ST7558_HEIGHT   65
+// Build with -DST7558_ENABLE_PIPELINE to send frames from a background 
+// task (ESP32, FreeRTOS) or thread (Linux) while the next one is drawn, 
+// see startFlushTask()
+#ifdef ST7558_ENABLE_PIPELINE
+    #include <atomic>
+    #if defined(ESP32)
+        #include <freertos/FreeRTOS.h>
+        #include <freertos/task.h>
+    #elif defined(__linux__)
+        #include <thread>
+        #include <mutex>
+        #include <condition_variable>
+    #else
+        #error "ST7558: ST7558_ENABLE_PIPELINE needs FreeRTOS (ESP32) or Linux threads"
+    #endif
+    #ifdef ST7558_STRIP_PAGES
+        #error "ST7558: ST7558_ENABLE_PIPELINE needs the full framebuffer"
+    #endif
+    #ifndef ST7558_PIPELINE_CORE
+        #define ST7558_PIPELINE_CORE        0   // ESP32: Arduino's loop() runs on core 1
+    #endif
+    #ifndef ST7558_PIPELINE_PRIORITY
+        #define ST7558_PIPELINE_PRIORITY    2
+    #endif
+    #define ST7558_PIPELINE_STACK           2048
+#endif
+
+#ifndef ST7558_TRANSPORT
+    #define ST7558_TRANSPORT ST7558WireTransport
+#endif
+typedef ST7558_TRANSPORT ST7558Bus;
+
+typedef void (*ST7558FlushCallback)(void);
+
+class ST7558Canvas;
+
+// what present() does when the flush task is still sending the last frame
+enum ST7558FrameSkip {
+
+    ST7558_SKIP_FRAME,                      // return at once, the changes go with the next frame
+    ST7558_WAIT_FRAME                       // block until the task is free
+};
+
+// Build with -DST7558_ENABLE_STATS to count bus traffic, flush times and 
+// draw calls, see getStats(). Without it the counting isn't compiled in
+#ifdef ST7558_ENABLE_STATS
+    #define ST7558_STAT(expr)   do { expr; } while (0)
+
+struct ST7558Stats {
+
+    uint32_t transactions;                  // I²C transactions sent
+    uint32_t payloadBytes;                  // display data bytes
+    uint32_t overheadBytes;                 // address, control and command bytes
+    uint32_t sentBytes;                     // data bytes sent by flushes
+    uint32_t skippedBytes;                  // framebuffer bytes flushes didn't send
+    uint32_t flushes;                       // flushes that sent data
+    uint32_t idleFlushes;                   // flushes with nothing to send
+    uint32_t flushMinUs;                    // start to last chunk, in µs
+    uint32_t flushMaxUs;
+    uint32_t flushTotalUs;                  // average is flushTotalUs / flushes
+    uint32_t pixels;                        // drawPixel() calls
+    uint32_t fills;                         // rectangles and lines filled
+    uint32_t blits;                         // blit() and drawBitmap() calls
+    uint32_t chars;                         // characters drawn
+};
+#else
+    #define ST7558_STAT(expr)   do {} while (0)
+#endif
+
+// Build with -DST7558_ENABLE_RECORDER to log every flushed frame to a Print 
+// (Serial, an SD file), see startRecording(). The format is in 
+// ST7558Delta.h, extras/host/player decodes it
+#ifdef ST7558_ENABLE_RECORDER
+    #ifdef ST7558_STRIP_PAGES
+        #error "ST7558: ST7558_ENABLE_RECORDER needs the full framebuffer"
+    #endif
+#endif
+
+// Panel geometry is fixed at compile time, so bounds checks and page 
+// counts fold into constants. Override with build flags for other glass, 
+// e.g. -DST7558_WIDTH=102 -DST7558_HEIGHT=66 for the whole display RAM
+#ifndef ST7558_WIDTH
+    #define ST7558_WIDTH    96              // visible columns, up to 102
+#endif
+#ifndef ST7558_HEIGHT
+    #define ST7558_HEIGHT   65              // visible rows, up to 66
+#endif
+#ifndef ST7558_COLUMN_OFFSET
+    #define ST7558_COLUMN_OFFSET    0       // RAM column of the leftmost visible one
+#endif
+#define ST7558_RAM_WIDTH    102             // display RAM, 9 pages of 102 columns
+#define ST7558_RAM_HEIGHT   66
+#define ST7558_RAM_PAGES    ((ST7558_RAM_HEIGHT + 7) / 8)
+#if ST7558_WIDTH + ST7558_COLUMN_OFFSET > ST7558_RAM_WIDTH || ST7558_HEIGHT > ST7558_RAM_HEIGHT
+    #error "ST7558: panel geometry doesn't fit the 102x66 display RAM"
+#endif
+#define ST7558_PAGES        ((ST7558_HEIGHT + 7) / 8)
+#define ST7558_BUFFER_SIZE  (ST7558_WIDTH * ST7558_PAGES)
 
-#define BLACK 1
-#define WHITE 0
+// Strip mode for RAM-starved MCUs: with -DST7558_STRIP_PAGES=n only n pages 
+// of framebuffer are kept (96 bytes for n = 1 instead of 864). The scene is 
+// drawn once per strip in a firstPage()/nextPage() loop, drawing is clipped 
+// to the strip and each strip is sent when it's done
+#ifdef ST7558_STRIP_PAGES
+    #if ST7558_STRIP_PAGES < 1 || ST7558_STRIP_PAGES > ST7558_PAGES
+        #error "ST7558: ST7558_STRIP_PAGES must be 1 to the panel's page count"
+    #endif
+    #define ST7558_STORAGE_SIZE (ST7558_WIDTH * ST7558_STRIP_PAGES)
+#else
+    #define ST7558_STORAGE_SIZE ST7558_BUFFER_SIZE
+#endif
+
+// Fast-mode (400 kHz) is the controller's rated maximum. Wiring that holds 
+// up at Fast-mode Plus may raise it, e.g. -DST7558_MAX_CLOCK=1000000
+#ifndef ST7558_MAX_CLOCK
+    #define ST7558_MAX_CLOCK    400000
+#endif
+
+#define ST7558_DIRTY_BLOCK      8   // columns covered by one bit of the per-page dirty mask
+#define ST7558_SPAN_OVERHEAD    6   // bytes-on-wire cost of opening one more span: X and Y
+                                    // commands (Co byte + command each) + address and 
+                                    // control byte of a new transaction
+#define ST7558_CMD_QUEUE        8   // commands that can wait for the next transaction
+#if 2 * ST7558_CMD_QUEUE + 2 > ST7558_MIN_BUFFER
+    #error "ST7558_MIN_BUFFER must hold a full command queue and a data byte"
+#endif
 
-#define I2C_MAX 32
+// define ST7558_NO_GLCDFONT to keep a second copy of the classic 5x7 font
+// out of flash (1280 bytes); classic text then goes through Adafruit_GFX
 
 #define ST7558_CMD                      0x00
 #define ST7558_DATA                     0x40
+#define ST7558_CONTINUE                 0x80        // Co = 1: one byte, then another control byte
 
 #define ST7558_I2C_ADDRESS              0b00111100  // 0x3c <- see datasheet
 #define NOP                             0b00000000  // 0x00 <- see datasheet
@@ -75,6 +201,19 @@
     #define MIRROR_X                    0b00000010  // 0x02 <- see datasheet
     #define MIRROR_Y                    0b00000100  // 0x04 <- see datasheet
 
+// The module is mounted for MX = MY = 1. Clearing MY mirrors the rows over 
+// the whole 66-row RAM, so the panel then shows the bottom RAM rows and 
+// flushes move the frame down by the rows it is shorter than the RAM: 
+// whole pages on the page address, the rest shifted into each byte. When 
+// that pushes the frame's last rows into one more RAM page, a flush sends 
+// that page too
+#define ST7558_MIRROR_Y_SHIFT   (ST7558_RAM_HEIGHT - ST7558_HEIGHT)
+#if (ST7558_HEIGHT - 1) % 8 + ST7558_MIRROR_Y_SHIFT % 8 >= 8
+    #define ST7558_FLUSH_PAGES  (ST7558_PAGES + 1)
+#else
+    #define ST7558_FLUSH_PAGES  ST7558_PAGES
+#endif
+
 /* H="0", basic mode */ 
 #define ST7558_VLCD                     0b00010000  // 0x10 <- see datasheet
     #define VLCD_HIGH                   0b00000001  // 0x01 <- see datasheet
@@ -105,26 +244,246 @@ class ST7558 : public Adafruit_GFX {
             
     private:
 
-        void _i2cwrite(const uint8_t type, const uint8_t *data, uint8_t n);
+        void _i2cwrite(const uint8_t type, const uint8_t *data, uint8_t n, 
+                       const bool progmem = false);
         void _hardreset(void);
-        void _setXY (const uint8_t x, const uint8_t y);
+        void _setXY (const uint8_t x, const uint8_t y, 
+                     const bool vertical = false);
+        void _command(const uint8_t cmd);
+        void _functionSet(const uint8_t mode);
+        void _queueDisplayMode(const uint8_t mode);
+        void _queueContrast(const uint8_t vop);
+        void _queuePending(void);
+        void _powerUp(void);
+        void _transmit(const uint8_t *data, uint8_t n, const bool progmem = false);
+        void _beginData(void);
+        void _endData(const uint8_t n);
+        void _markDirty(const uint8_t page, const uint8_t x0, const uint8_t x1);
+        void _markInk(const uint8_t page, const uint8_t x0, const uint8_t x1);
+        void _markAllDirty(void);
+        void _setMirror(const uint8_t bits);
+        bool _orient(const uint8_t rotation, const uint8_t flips);
+        void _transposeRotated(void);
+        uint8_t _flushByte(const uint8_t page, const uint8_t x);
+
+        // change tracking for the ST7558Raster kernels
+        struct Marker {
+
+            ST7558 &lcd;
+            Marker(ST7558 &lcd) : lcd(lcd) {}
+            void operator()(uint8_t page, uint8_t x0, uint8_t x1, bool ink) const;
+        };
+        void _fillArea(const uint8_t x0, const uint8_t x1, 
+                       const uint8_t y0, const uint8_t y1, 
+                       const uint16_t color);
+        void _blit(int16_t x, int16_t y, const uint8_t *bitmap, 
+                   const uint8_t w, const uint8_t h, const ST7558RasterOp op, 
+                   const uint8_t *mask, const bool progmem, const bool invert);
+        void _drawRowMajor(int16_t x, int16_t y, const uint8_t *bitmap, 
+                           int16_t w, int16_t h, const ST7558RasterOp op, 
+                           const bool progmem, const bool invert);
+        void _drawGlyph(int16_t x, int16_t y, const uint8_t *cols, 
+                        uint16_t color, uint16_t bg);
+        void _drawColumns(int16_t x, int16_t y, const uint8_t *cols, 
+                          const uint8_t w, const ST7558RasterOp op, 
+                          const bool invert);
+        uint8_t _action(const uint16_t color);
+        bool _colorOp(const uint16_t color, const bool background, 
+                      ST7558RasterOp &op, bool &invert);
+        bool _drawFontChar(int16_t x, int16_t y, unsigned char c, 
+                           uint16_t color);
+        ST7558Bus _bus;
         uint8_t _rst_pin;
         uint32_t clock;
+        uint8_t _chunk;                     // bytes per transaction, from the bus
+        uint8_t _storage[ST7558_STORAGE_SIZE];  // this panel's own framebuffer
+        uint8_t *_buffer;                   // draw target
+        uint8_t *_front;                    // shown buffer, == _buffer unless double buffered
+        uint8_t *_back;                     // caller's back buffer, NULL if single buffered
+        ST7558RasterOp _rop;                // how colors combine with the framebuffer
+        ST7558Canvas *_rotated;             // draw target at rotation 90/270, NULL otherwise
+        bool _rotatedDirty;                 // drawn on since it was last transposed
+        uint8_t _flips;                     // setMirror(), as MIRROR_X/MIRROR_Y bits
+#ifdef ST7558_STRIP_PAGES
+        uint8_t _stripFirst;                // pages held in _storage, the 
+        uint8_t _stripLast;                 // strip being drawn
+        void _sendStrip(void);
+#endif
+
+        // transaction builder: queued commands ride in front of the next 
+        // transaction, each as a Co = 1 control byte + command pair
+        uint8_t _cmd[ST7558_CMD_QUEUE];
+        uint8_t _cmdCount;
+
+        // controller state as last sent, 0xFF - unknown. Commands that 
+        // wouldn't change it are not sent
+        uint8_t _fs;                        // PD/V/H bits of the last function set
+        uint8_t _ramX;                      // RAM address pointer
+        uint8_t _ramY;
+        uint8_t _displayMode;               // last display control
+        uint8_t _vop;                       // last contrast
+        uint8_t _mirror;                    // MX/MY bits of the extended display control
+        uint8_t _columnOffset;              // RAM column of framebuffer column 0
+        uint8_t _pageShift;                 // RAM pages the frame sits below page 0,
+        uint8_t _rowShift;                  // and rows on top of that
+
+        bool _deferCommands;                // see deferCommands()
+        uint8_t _pendingMode;               // deferred display control, 0xFF - none
+        uint8_t _pendingVop;                // deferred contrast, 0xFF - none
+
+        bool _asleep;                       // power down mode, flushes are held
+        bool _idleSleep;                    // put to sleep by the inactivity timer
+        uint32_t _sleepTimeout;             // ms without a flush before sleeping, 0 - never
+        uint32_t _lastActivity;             // millis() of the last flush that sent data
+
+        // dirty columns of one page. min > max means clean
+        struct DirtySpan {
+
+            uint8_t min;
+            uint8_t max;
+            uint16_t mask;                  // bit n -> columns [n*ST7558_DIRTY_BLOCK, (n+1)*ST7558_DIRTY_BLOCK)
+        };
+
+        // per-page bookkeeping for partial updates. 'dirty' is what display() 
+        // still has to send, 'ink' is where set pixels may be, so clearing 
+        // only has to resend those columns. inkMin > inkMax means no ink.
+        struct PageState {
+
+            DirtySpan dirty;
+            uint8_t inkMin;
+            uint8_t inkMax;
+            DirtySpan prevDirty;            // double buffering: what the last flush 
+            uint8_t otherInkMin;            // changed on screen and ink of the 
+            uint8_t otherInkMax;            // other buffer
+        } _page[ST7558_PAGES];
+        bool _fullFlush;                    // RAM may differ from the shown buffer anywhere
+
+        // flush in progress: a snapshot of the dirty spans taken by 
+        // beginFlush() and the position reached in it
+        DirtySpan _flushPage[ST7558_FLUSH_PAGES];
+        const uint8_t *_flushSource;
+        bool _flushProgmem;
+        uint8_t _flushIndex;                // page being sent, ST7558_FLUSH_PAGES when idle
+        uint8_t _flushFrom;                 // where to look for the page's next span
+        uint8_t _flushX;                    // next column to send
+        uint8_t _flushEnd;                  // last column of the current span
+        bool _flushAddress;                 // _setXY still due for the current span
+        bool _flushVertical;                // one column-major block instead of spans:
+        uint8_t _flushY;                    // next page to send, wraps at ST7558_RAM_PAGES
+        uint8_t _flushLast;                 // page of the block's last byte
+        ST7558FlushCallback _flushCallback;
+
+#ifdef ST7558_ENABLE_STATS
+        ST7558Stats _stats;
+        uint32_t _flushStarted;             // micros() at the running flush's start
+        uint16_t _flushBytes;               // data bytes it has sent so far
+        void _statsFlushDone(void);
+#endif
+
+#ifdef ST7558_ENABLE_RECORDER
+        Print *_recSink;                    // NULL - not recording
+        uint8_t *_recReference;             // the frame last recorded
+        uint16_t _recFrames;
+        bool _recKey;                       // record the next frame whole
+        void _recordFrame(void);
+#endif
+
+        bool _nextSpan(const DirtySpan &dirty, const uint8_t from, 
+                       uint8_t &x0, uint8_t &x1);
+        void _trimToChanges(const uint8_t page, DirtySpan &span);
+        bool _pickVertical(void);
+        void _flushStart(void);
+        void _flushAdvance(void);
+        bool _flushStep(void);
+
+#ifdef ST7558_ENABLE_PIPELINE
+        // background flush: a single-slot handoff. The app fills the flush 
+        // snapshot and publishes it with _pipeState, the task sends it and 
+        // hands the slot back; only the sleeping uses a lock or notification
+        std::atomic<uint8_t> _pipeState;
+        bool _pipeRunning;
+        bool _pipeDefer;                    // deferCommands() wish, applied at stop
+        ST7558FrameSkip _pipeSkip;
+        uint32_t _pipeSkipped;
+    #if defined(ESP32)
+        TaskHandle_t _pipeTask;
+        std::atomic<TaskHandle_t> _pipeWaiter;  // task blocked in waitFlush()
+    #else
+        std::thread _pipeThread;
+        std::mutex _pipeLock;
+        std::condition_variable _pipeWake;
+    #endif
+        bool _pipeSubmit(const bool wait);
+        void _pipeRelease(const uint8_t state);
+        void _pipeLoop(void);
+        static void _pipeMain(void *self);
+#endif
 
     public:
 
         ST7558(uint8_t rst_pin);
         ST7558(uint8_t rst_pin, uint32_t clock);
-        void begin(void);
+        ST7558(uint8_t rst_pin, const ST7558Bus &bus, uint32_t clock = 100000);
+        ~ST7558();
+        bool begin(void);
+        uint32_t getClock(void);
         void displayOff(void);
         void displayOn(void);
         void setContrast(const uint8_t value);
         void invertDisplay(const bool state);
+        void deferCommands(const bool state);
+        void sleep(void);
+        void wake(void);
+        bool isAsleep(void);
+#ifndef ST7558_STRIP_PAGES
+        void setSleepTimeout(const uint32_t ms);
+#endif
         void clearDisplay(void);
+#ifdef ST7558_STRIP_PAGES
+        void firstPage(void);
+        bool nextPage(void);
+#else
         void display(void);
+        void displayFull(void);
+        bool displayAsync(void);
+        bool beginFlush(void);
+#endif
+        bool beginFlush(const uint8_t *frame);
+        void displayFrame(const uint8_t *frame);
+        bool poll(const uint16_t budget_us = 0);
+        bool isBusy(void);
+        void waitFlush(void);
+        void onFlushComplete(ST7558FlushCallback callback);
+#ifdef ST7558_ENABLE_PIPELINE
+        bool startFlushTask(uint8_t *backBuffer, 
+                            ST7558FrameSkip policy = ST7558_SKIP_FRAME);
+        void stopFlushTask(void);
+        bool present(void);
+        uint32_t getSkippedFrames(void);
+#endif
         uint8_t *getBuffer(void);
+#ifndef ST7558_STRIP_PAGES
+        void attachBuffer(uint8_t *buffer);
+        void setBackBuffer(uint8_t *buffer);
+#endif
         uint16_t getBufferSize(void);
         uint8_t getPixel(const uint8_t x, const uint8_t y);
+        ST7558Bus &getBus(void);
+#ifdef ST7558_ENABLE_STATS
+        const ST7558Stats &getStats(void);
+        void resetStats(void);
+        void printStats(Print &out);
+#endif
+#ifdef ST7558_ENABLE_RECORDER
+        void startRecording(Print &sink, uint8_t *reference);
+        void stopRecording(void);
+#endif
+
+        void setRasterOp(ST7558RasterOp op);
+        ST7558RasterOp getRasterOp(void);
+
+        void setRotation(uint8_t r);
+        void setMirror(const bool x, const bool y);
 
         void drawPixel(int16_t x, int16_t y, 
                         uint16_t color);
@@ -132,9 +491,33 @@ class ST7558 : public Adafruit_GFX {
         void drawRect(int16_t x, int16_t y, int16_t w, 
                       int16_t h, uint16_t color);
 
+        void drawRoundRect(int16_t x, int16_t y, int16_t w, 
+                           int16_t h, int16_t r, uint16_t color);
+
+        void fillRoundRect(int16_t x, int16_t y, int16_t w, 
+                           int16_t h, int16_t r, uint16_t color);
+
+        void drawCircle(int16_t x0, int16_t y0, int16_t r, 
+                        uint16_t color);
+
         void fillRect(int16_t x, int16_t y, int16_t w, 
                       int16_t h, uint16_t color);
 
+        void drawFastHLine(int16_t x, int16_t y, int16_t w, 
+                           uint16_t color);
+
+        void drawFastVLine(int16_t x, int16_t y, int16_t h, 
+                           uint16_t color);
+
+        void writeFillRect(int16_t x, int16_t y, int16_t w, 
+                           int16_t h, uint16_t color);
+
+        void writeFastHLine(int16_t x, int16_t y, int16_t w, 
+                            uint16_t color);
+
+        void writeFastVLine(int16_t x, int16_t y, int16_t h, 
+                            uint16_t color);
+
         void drawSquare(int16_t x, int16_t y, int16_t a, 
                         uint16_t color);    
 
@@ -142,9 +525,62 @@ class ST7558 : public Adafruit_GFX {
                         uint16_t color);   
 
         void fillScreen(int16_t color);
+
+#ifndef ST7558_STRIP_PAGES
+        void scroll(int16_t x, int16_t y, int16_t w, int16_t h, 
+                    int16_t dx, int16_t dy, uint16_t color = WHITE);
+
+        void scrollX(int16_t dx, uint16_t color = WHITE);
+
+        void scrollY(int16_t dy, uint16_t color = WHITE);
+#endif
+
+        void blit(int16_t x, int16_t y, const uint8_t *bitmap, 
+                  uint8_t w, uint8_t h, 
+                  ST7558RasterOp op = ST7558_ROP_COPY, 
+                  const uint8_t *mask = NULL);
+
+        void blit(int16_t x, int16_t y, uint8_t *bitmap, 
+                  uint8_t w, uint8_t h, 
+                  ST7558RasterOp op = ST7558_ROP_COPY, 
+                  uint8_t *mask = NULL);
+
+        void blit(int16_t x, int16_t y, ST7558Canvas &canvas, 
+                  ST7558RasterOp op = ST7558_ROP_COPY);
+
+        static void toPageMajor(const uint8_t *bitmap, uint8_t w, 
+                                uint8_t h, uint8_t *out);
+
+        static void toPageMajor(uint8_t *bitmap, uint8_t w, 
+                                uint8_t h, uint8_t *out);
+
+        using Adafruit_GFX::drawBitmap;
+        void drawBitmap(int16_t x, int16_t y, const uint8_t bitmap[], 
+                        int16_t w, int16_t h, uint16_t color);
+
+        void drawBitmap(int16_t x, int16_t y, const uint8_t bitmap[], 
+                        int16_t w, int16_t h, uint16_t color, 
+                        uint16_t bg);
+
+        void drawBitmap(int16_t x, int16_t y, uint8_t *bitmap, 
+                        int16_t w, int16_t h, uint16_t color);
+
+        void drawBitmap(int16_t x, int16_t y, uint8_t *bitmap, 
+                        int16_t w, int16_t h, uint16_t color, 
+                        uint16_t bg);
+
+        using Adafruit_GFX::drawChar;
+        void drawChar(int16_t x, int16_t y, unsigned char c, 
+                      uint16_t color, uint16_t bg, 
+                      uint8_t size_x, uint8_t size_y);
+
+        using Adafruit_GFX::write;
+        size_t write(uint8_t c);
          
+#ifndef ST7558_STRIP_PAGES
         void pushBuffer(uint8_t *buffer, 
                         const uint16_t size);
+#endif
 
 
         // old code
@@ -0,0 +1,301 @@
+/**
+ * @file ST7558Animation.cpp
+ *
+ * Animation player, see ST7558Animation.h
+ *
+ * @section License
+ *
+ *  GNU GENERAL PUBLIC LICENSE ver. 3
+ *
+ */
+
+#include "ST7558Animation.h"
+
+#ifndef ST7558_STRIP_PAGES
+
+#define STATE_STOPPED   0
+#define STATE_HEADER    1                   // stream header
+#define STATE_MARK      2                   // looking for a record mark
+#define STATE_RECORD    3                   // record header
+#define STATE_CODE      4
+#define STATE_REPEAT    5                   // repeat code, its byte next
+#define STATE_WAIT      6                   // record read, not due yet
+#define STATE_LITERAL   7                   // literal code, _count bytes next
+
+ST7558Animation::ST7558Animation(ST7558 &lcd) :
+    _lcd(lcd), _data(NULL), _stream(NULL), _size(0), _at(0),
+    _state(STATE_STOPPED), _headCount(0), _count(0), _pos(0),
+    _time(0), _first(0), _start(0), _frames(0), _loop(true), _timed(false), _played(false) {}
+
+/**************************************************************/
+/** @brief Play an animation from flash. The first frame is due
+           at once
+    @param  data    PROGMEM stream, e.g. written by
+                    extras/host/encoder
+    @param  size    its bytes
+    @return false if it isn't a stream for this panel
+*/
+/**************************************************************/
+bool ST7558Animation::begin(const uint8_t *data, const uint16_t size) {
+
+    _data = data;
+    _stream = NULL;
+    _size = size;
+    _at = ST7558_REC_HEADER;
+    _frames = 0;
+    _timed = false;
+    _played = false;
+    _state = STATE_STOPPED;
+    if (size >= ST7558_REC_HEADER
+            && pgm_read_byte(&data[0]) == ST7558_REC_MAGIC
+            && pgm_read_byte(&data[1]) == ST7558_REC_VERSION
+            && pgm_read_byte(&data[2]) == ST7558_WIDTH
+            && pgm_read_byte(&data[3]) == ST7558_HEIGHT) {
+        _state = STATE_MARK;
+    }
+    return _state != STATE_STOPPED;
+}
+
+/**************************************************************/
+/** @brief Play an animation as it comes in from a stream. The
+           header is checked when it arrives, a stream for
+           another panel stops the player
+*/
+/**************************************************************/
+void ST7558Animation::begin(Stream &stream) {
+
+    _data = NULL;
+    _stream = &stream;
+    _headCount = 0;
+    _frames = 0;
+    _timed = false;
+    _played = false;
+    _state = STATE_HEADER;
+}
+
+void ST7558Animation::stop(void) {
+
+    _state = STATE_STOPPED;
+}
+
+/**************************************************************/
+/** @brief Decode the next frame into the framebuffer once it is
+           due, by the times it was made with. Call it from
+           loop(), and display() when it returns true
+    @return true if a frame was decoded
+*/
+/**************************************************************/
+bool ST7558Animation::update(void) {
+
+    return _decode(false);
+}
+
+/**************************************************************/
+/** @brief Decode the next frame now, whatever its time. Later
+           frames keep their spacing from it
+    @return true if a frame was decoded, false at the end, or if
+            a stream has no more data yet
+*/
+/**************************************************************/
+bool ST7558Animation::nextFrame(void) {
+
+    return _decode(true);
+}
+
+/**************************************************************/
+/** @brief Start over from the first frame at the end of a flash
+           animation, on by default. The last record of an
+           encoded one is empty and only sets the time the loop
+           takes. A pass that decodes no frame, e.g. over corrupt
+           data, stops the player instead
+*/
+/**************************************************************/
+void ST7558Animation::setLoop(const bool state) {
+
+    _loop = state;
+}
+
+bool ST7558Animation::isPlaying(void) {
+
+    return _state != STATE_STOPPED;
+}
+
+/**************************************************************/
+/** @brief This method returns the number of frames decoded
+*/
+/**************************************************************/
+uint16_t ST7558Animation::getFrame(void) {
+
+    return _frames;
+}
+
+/**************************************************************/
+/** @brief This method reads a byte of the source
+    @return -1 at the end of the data, or if a stream has no
+            more yet
+*/
+/**************************************************************/
+int16_t ST7558Animation::_read(void) {
+
+    if (_stream) {
+        return _stream->read();
+    }
+    return (_at < _size) ? pgm_read_byte(&_data[_at++]) : -1;
+}
+
+/**************************************************************/
+/** @brief This method XORs a run of frame bytes into the
+           framebuffer from _pos on, one page-aligned blit per
+           page it crosses
+*/
+/**************************************************************/
+void ST7558Animation::_apply(const uint8_t *bytes, uint8_t n, const bool progmem) {
+
+    while (n) {
+
+        const uint8_t page = _pos / ST7558_WIDTH;
+        const uint8_t x = _pos % ST7558_WIDTH;
+        const uint8_t w = (n < ST7558_WIDTH - x) ? n : ST7558_WIDTH - x;
+        if (progmem) {
+            _lcd.blit(x, page * 8, bytes, w, 8, ST7558_ROP_XOR);
+        } else {
+            _lcd.blit(x, page * 8, (uint8_t *)bytes, w, 8, ST7558_ROP_XOR);
+        }
+        bytes += w;
+        _pos += w;
+        n -= w;
+    }
+}
+
+/**************************************************************/
+/** @brief This method runs the decoder until a frame is done,
+           or it has to wait for its time or for data. Literal
+           runs from flash are blitted in place, others are
+           gathered in a run buffer first. A corrupt record is
+           given up on at the bad code, decoding picks up at
+           the next record mark
+    @param  now     don't wait for the frame's time
+*/
+/**************************************************************/
+bool ST7558Animation::_decode(const bool now) {
+
+    uint8_t run[ST7558_REC_RUN];
+    for (;;) {
+
+        int16_t b = 0;
+        if (_state >= STATE_HEADER && _state <= STATE_REPEAT && (b = _read()) < 0) {
+
+            if (_stream) {
+                return false;               // more to come
+            }
+            if (!_loop || !_played) {
+                _state = STATE_STOPPED;     // nothing to loop, e.g. corrupt or cut short
+                return false;
+            }
+            _played = false;
+            _at = ST7558_REC_HEADER;
+            _start += _time - _first;       // the first frame is due when the last one ends
+            _state = STATE_MARK;
+            continue;
+        }
+        switch (_state) {
+
+            case STATE_HEADER:
+                _head[_headCount++] = b;
+                if (_headCount == ST7558_REC_HEADER) {
+                    const bool ok = _head[0] == ST7558_REC_MAGIC && _head[1] == ST7558_REC_VERSION
+                                    && _head[2] == ST7558_WIDTH && _head[3] == ST7558_HEIGHT;
+                    _state = ok ? STATE_MARK : STATE_STOPPED;
+                }
+                break;
+
+            case STATE_MARK:
+                if (b == ST7558_REC_KEY || b == ST7558_REC_FRAME) {
+                    _head[0] = b;
+                    _headCount = 1;
+                    _state = STATE_RECORD;
+                }
+                break;
+
+            case STATE_RECORD:
+                _head[_headCount++] = b;
+                if (_headCount == ST7558_REC_RECORD) {
+                    _time = _head[3] | ((uint16_t)_head[4] << 8)
+                            | ((uint32_t)_head[5] << 16) | ((uint32_t)_head[6] << 24);
+                    _state = STATE_WAIT;
+                }
+                break;
+
+            case STATE_WAIT:
+                if (!_timed) {
+                    _first = _time;
+                    _start = millis();
+                    _timed = true;
+                }
+                if (now) {
+                    _start = millis() - (_time - _first);
+                } else if (millis() - _start < _time - _first) {
+                    return false;
+                }
+                if (_head[0] == ST7558_REC_KEY) {
+                    _lcd.clearDisplay();
+                }
+                _pos = 0;
+                _state = STATE_CODE;
+                break;
+
+            case STATE_CODE: {
+                if (b == ST7558_REC_END) {
+                    _frames++;
+                    _played = true;
+                    _state = STATE_MARK;
+                    return true;
+                }
+                const uint8_t n = (b & (ST7558_REC_RUN - 1)) + 1;
+                if (b >= ST7558_REC_LITERAL + ST7558_REC_RUN || _pos + n > ST7558_BUFFER_SIZE) {
+                    _state = STATE_MARK;
+                } else if (b < ST7558_REC_REPEAT) {
+                    _pos += n;
+                } else {
+                    _count = n;
+                    _state = (b < ST7558_REC_LITERAL) ? STATE_REPEAT : STATE_LITERAL;
+                }
+                break;
+            }
+
+            case STATE_REPEAT:
+                memset(run, b, _count);
+                _apply(run, _count, false);
+                _state = STATE_CODE;
+                break;
+
+            case STATE_LITERAL:
+                if (_stream) {
+
+                    uint8_t n = 0;
+                    while (n < _count && (b = _read()) >= 0) {
+                        run[n++] = b;
+                    }
+                    _apply(run, n, false);
+                    _count -= n;
+                    if (_count) {
+                        return false;
+                    }
+                } else if (_size - _at < _count) {
+                    _at = _size;            // cut short, end or loop from here
+                    _state = STATE_MARK;
+                    break;
+                } else {
+                    _apply(&_data[_at], _count, true);
+                    _at += _count;
+                }
+                _state = STATE_CODE;
+                break;
+
+            default:
+                return false;
+        }
+    }
+}
+
+#endif
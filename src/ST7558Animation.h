@@ -0,0 +1,81 @@
+/**
+ * @file ST7558Animation.h
+ *
+ * Animation player for the ST7558 driver. It plays the delta coded
+ * streams of ST7558Delta.h, made offline by extras/host/encoder from PBM
+ * images or recorded with ST7558::startRecording(): a key frame, then the
+ * bytes each frame changes, XORed with the last one and run-length coded.
+ * A splash screen or a status animation takes a few dozen bytes of flash
+ * per frame instead of a whole framebuffer.
+ *
+ * Records are decoded as they are read, from PROGMEM or from a Stream
+ * (Serial, an SD file), straight into the framebuffer with XOR blits. Only
+ * the columns a frame changes are marked, so display() sends just those.
+ *
+ *     ST7558Animation animation(lcd);
+ *     animation.begin(spinner, sizeof(spinner));
+ *     ...
+ *     if (animation.update()) {
+ *         lcd.display();
+ *     }
+ *
+ * Frames are in the panel's layout, play them at rotation 0 or 180. Delta
+ * frames build on what the screen shows: don't draw over the animation
+ * between frames. Not available in strip mode.
+ *
+ * @section License
+ *
+ *  GNU GENERAL PUBLIC LICENSE ver. 3
+ *
+ */
+
+#ifndef ST7558_ANIMATION_H
+#define ST7558_ANIMATION_H
+
+#include "ST7558.h"
+
+#ifndef ST7558_STRIP_PAGES
+
+class ST7558Animation {
+
+    private:
+
+        ST7558 &_lcd;
+        const uint8_t *_data;               // PROGMEM source, or
+        Stream *_stream;                    // a stream source
+        uint16_t _size, _at;                // PROGMEM bytes, next one to read
+        uint8_t _state;
+        uint8_t _head[ST7558_REC_RECORD];   // stream or record header being read
+        uint8_t _headCount;
+        uint8_t _count;                     // bytes left of the current run
+        uint16_t _pos;                      // frame byte the next run starts at
+        uint32_t _time;                     // record time, as stored
+        uint32_t _first;                    // time of the record playback started at
+        uint32_t _start;                    // millis() at that record
+        uint16_t _frames;
+        bool _loop;
+        bool _timed;                        // _first and _start set
+        bool _played;                       // a frame decoded since the last start over
+
+        int16_t _read(void);
+        void _apply(const uint8_t *bytes, uint8_t n, bool progmem);
+        bool _decode(bool now);
+
+    public:
+
+        ST7558Animation(ST7558 &lcd);
+
+        bool begin(const uint8_t *data, uint16_t size);
+        void begin(Stream &stream);
+        void stop(void);
+
+        bool update(void);
+        bool nextFrame(void);
+
+        void setLoop(bool state);
+        bool isPlaying(void);
+        uint16_t getFrame(void);
+};
+
+#endif
+#endif
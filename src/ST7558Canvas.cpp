@@ -0,0 +1,435 @@
+/**
+ * @file ST7558Canvas.cpp
+ *
+ * Page-major off-screen canvas, see ST7558Canvas.h
+ *
+ * @section License
+ *
+ *  GNU GENERAL PUBLIC LICENSE ver. 3
+ *
+ */
+
+#include "ST7558Canvas.h"
+#include <stdlib.h>
+
+// a canvas has no dirty tracking to feed
+static void _noMark(uint8_t page, uint8_t x0, uint8_t x1, bool ink) {
+
+    (void)page;
+    (void)x0;
+    (void)x1;
+    (void)ink;
+}
+
+/**************************************************************/
+/** @brief Canvas with its own buffer, cleared. If the
+           allocation fails getBuffer() returns NULL and drawing
+           does nothing
+    @param  w   width, 1..255
+    @param  h   height, 1..255
+*/
+/**************************************************************/
+ST7558Canvas::ST7558Canvas(const uint8_t w, const uint8_t h) :
+    Adafruit_GFX(w, h), _owned(true), _rop(ST7558_ROP_COPY) {
+
+    _buffer = (uint8_t *)calloc(1, w * ((h + 7) / 8));
+}
+
+/**************************************************************/
+/** @brief Canvas on a caller's buffer, e.g. a static array or a
+           page-major bitmap to draw over. Its content is kept
+    @param  buffer  w * ((h + 7) / 8) bytes
+*/
+/**************************************************************/
+ST7558Canvas::ST7558Canvas(const uint8_t w, const uint8_t h, uint8_t *buffer) :
+    Adafruit_GFX(w, h), _buffer(buffer), _owned(false), _rop(ST7558_ROP_COPY) {
+}
+
+ST7558Canvas::~ST7558Canvas(void) {
+
+    if (_owned) {
+        free(_buffer);
+    }
+}
+
+uint8_t *ST7558Canvas::getBuffer(void) {
+    return _buffer;
+}
+
+uint16_t ST7558Canvas::getBufferSize(void) {
+    return WIDTH * ((HEIGHT + 7) / 8);
+}
+
+uint8_t ST7558Canvas::getPixel(const int16_t x, const int16_t y) {
+
+    if (_buffer && x >= 0 && x < WIDTH && y >= 0 && y < HEIGHT) {
+        return (_buffer[x + (y / 8) * WIDTH] >> y % 8) & 1;
+    }
+    return 0;
+}
+
+/**************************************************************/
+/** @brief Set how colors combine with the canvas, the same as
+           ST7558::setRasterOp()
+*/
+/**************************************************************/
+void ST7558Canvas::setRasterOp(ST7558RasterOp op) {
+    _rop = op;
+}
+
+ST7558RasterOp ST7558Canvas::getRasterOp(void) {
+    return _rop;
+}
+
+bool ST7558Canvas::_colorOp(const uint16_t color, const bool background,
+                            ST7558RasterOp &op, bool &invert) {
+    return ST7558Raster::colorOp(ST7558Raster::action(color, _rop), background, op, invert);
+}
+
+void ST7558Canvas::drawPixel(const int16_t x, const int16_t y, const uint16_t color) {
+
+    if (!_buffer || x < 0 || x >= WIDTH || y < 0 || y >= HEIGHT) {
+        return;
+    }
+    uint8_t &byte = _buffer[x + (y / 8) * WIDTH];
+    switch (ST7558Raster::action(color, _rop)) {
+        case ST7558_DRAW_SET:   byte |= 1 << y % 8; break;
+        case ST7558_DRAW_CLEAR: byte &= ~(1 << y % 8); break;
+        case ST7558_DRAW_FLIP:  byte ^= 1 << y % 8; break;
+    }
+}
+
+/**************************************************************/
+/** @brief Draw a rectangle outline, each pixel once
+*/
+/**************************************************************/
+void ST7558Canvas::drawRect(const int16_t x, const int16_t y,
+                            const int16_t w, const int16_t h,
+                            const uint16_t color) {
+
+    ST7558Raster::rect(x, y, w, h, [this, color](int16_t fx, int16_t fy, int16_t fw, int16_t fh) {
+        fillRect(fx, fy, fw, fh, color);
+    });
+}
+
+/**************************************************************/
+/** @brief Draw a rectangle with rounded corners, each pixel
+           once, see ST7558Raster::roundRect()
+*/
+/**************************************************************/
+void ST7558Canvas::drawRoundRect(const int16_t x, const int16_t y,
+                                 const int16_t w, const int16_t h,
+                                 const int16_t r, const uint16_t color) {
+
+    ST7558Raster::roundRect(x, y, w, h, r,
+        [this, color](int16_t fx, int16_t fy, int16_t fw, int16_t fh) {
+            fillRect(fx, fy, fw, fh, color);
+        },
+        [this, color](int16_t px, int16_t py) {
+            drawPixel(px, py, color);
+        });
+}
+
+/**************************************************************/
+/** @brief Draw a filled rectangle with rounded corners, see
+           ST7558::fillRoundRect()
+*/
+/**************************************************************/
+void ST7558Canvas::fillRoundRect(const int16_t x, const int16_t y,
+                                 const int16_t w, const int16_t h,
+                                 const int16_t r, const uint16_t color) {
+
+    if (ST7558Raster::filledRoundRectIsRect(w, h, r)) {
+        fillRect(x, y, w, h, color);
+        return;
+    }
+    Adafruit_GFX::fillRoundRect(x, y, w, h, r, color);
+}
+
+/**************************************************************/
+/** @brief Draw a circle outline, each pixel once
+*/
+/**************************************************************/
+void ST7558Canvas::drawCircle(const int16_t x0, const int16_t y0,
+                              const int16_t r, const uint16_t color) {
+
+    ST7558Raster::circle(x0, y0, r, [this, color](int16_t px, int16_t py) {
+        drawPixel(px, py, color);
+    });
+}
+
+/**************************************************************/
+/** @brief Draw a filled rectangle. Clipped once, then filled
+           page by page with byte masks
+*/
+/**************************************************************/
+void ST7558Canvas::fillRect(int16_t x, int16_t y,
+                            const int16_t w, const int16_t h,
+                            const uint16_t color) {
+
+    if (!_buffer || w <= 0 || h <= 0) {
+        return;
+    }
+
+    int16_t x1 = x + w - 1;
+    int16_t y1 = y + h - 1;
+    if (x < 0) {
+        x = 0;
+    }
+    if (y < 0) {
+        y = 0;
+    }
+    if (x1 >= WIDTH) {
+        x1 = WIDTH - 1;
+    }
+    if (y1 >= HEIGHT) {
+        y1 = HEIGHT - 1;
+    }
+    if (x <= x1 && y <= y1) {
+        _fillArea(x, x1, y, y1, color);
+    }
+}
+
+void ST7558Canvas::drawFastHLine(const int16_t x, const int16_t y,
+                                 const int16_t w, const uint16_t color) {
+    fillRect(x, y, w, 1, color);
+}
+
+void ST7558Canvas::drawFastVLine(const int16_t x, const int16_t y,
+                                 const int16_t h, const uint16_t color) {
+    fillRect(x, y, 1, h, color);
+}
+
+/**************************************************************/
+/** @brief Adafruit_GFX batched-write hooks, used by circles,
+           round rects, triangles and text
+*/
+/**************************************************************/
+void ST7558Canvas::writeFillRect(const int16_t x, const int16_t y,
+                                 const int16_t w, const int16_t h,
+                                 const uint16_t color) {
+    ST7558Canvas::fillRect(x, y, w, h, color);
+}
+
+void ST7558Canvas::writeFastHLine(const int16_t x, const int16_t y,
+                                  const int16_t w, const uint16_t color) {
+    ST7558Canvas::fillRect(x, y, w, 1, color);
+}
+
+void ST7558Canvas::writeFastVLine(const int16_t x, const int16_t y,
+                                  const int16_t h, const uint16_t color) {
+    ST7558Canvas::fillRect(x, y, 1, h, color);
+}
+
+void ST7558Canvas::fillScreen(const uint16_t color) {
+
+    if (_buffer) {
+        _fillArea(0, WIDTH - 1, 0, HEIGHT - 1, color);
+    }
+}
+
+/**************************************************************/
+/** @brief This method fills an already clipped area, see
+           ST7558Raster::fill()
+*/
+/**************************************************************/
+void ST7558Canvas::_fillArea(const uint8_t x0, const uint8_t x1,
+                             const uint8_t y0, const uint8_t y1,
+                             const uint16_t color) {
+
+    const uint8_t action = ST7558Raster::action(color, _rop);
+    if (action != ST7558_DRAW_NONE) {
+        ST7558Raster::fill(_buffer, WIDTH, 0, x0, x1, y0, y1, action, _noMark);
+    }
+}
+
+/**************************************************************/
+/** @brief Shift an area of the canvas, see ST7558::scroll()
+*/
+/**************************************************************/
+void ST7558Canvas::scroll(int16_t x, int16_t y, const int16_t w, const int16_t h,
+                          const int16_t dx, const int16_t dy, const uint16_t color) {
+
+    if (!_buffer || w <= 0 || h <= 0 || (!dx && !dy)) {
+        return;
+    }
+
+    int16_t x1 = x + w - 1;
+    int16_t y1 = y + h - 1;
+    if (x < 0) {
+        x = 0;
+    }
+    if (y < 0) {
+        y = 0;
+    }
+    if (x1 >= WIDTH) {
+        x1 = WIDTH - 1;
+    }
+    if (y1 >= HEIGHT) {
+        y1 = HEIGHT - 1;
+    }
+    if (x <= x1 && y <= y1) {
+        ST7558Raster::scroll(_buffer, WIDTH, x, x1, y, y1, dx, dy,
+                             color == BLACK ? 0xFF : 0x00, _noMark);
+    }
+}
+
+void ST7558Canvas::scrollX(const int16_t dx, const uint16_t color) {
+    scroll(0, 0, WIDTH, HEIGHT, dx, 0, color);
+}
+
+void ST7558Canvas::scrollY(const int16_t dy, const uint16_t color) {
+    scroll(0, 0, WIDTH, HEIGHT, 0, dy, color);
+}
+
+/**************************************************************/
+/** @brief Blit a page-major bitmap, see ST7558::blit()
+    @param  bitmap  bitmap in PROGMEM
+    @param  mask    optional transparency mask in the same format
+*/
+/**************************************************************/
+void ST7558Canvas::blit(const int16_t x, const int16_t y, const uint8_t *bitmap,
+                        const uint8_t w, const uint8_t h,
+                        const ST7558RasterOp op, const uint8_t *mask) {
+    _blit(x, y, bitmap, w, h, op, mask, true, false);
+}
+
+/**************************************************************/
+/** @brief Same as above, with the bitmap and mask in RAM
+*/
+/**************************************************************/
+void ST7558Canvas::blit(const int16_t x, const int16_t y, uint8_t *bitmap,
+                        const uint8_t w, const uint8_t h,
+                        const ST7558RasterOp op, uint8_t *mask) {
+    _blit(x, y, bitmap, w, h, op, mask, false, false);
+}
+
+/**************************************************************/
+/** @brief Blit another canvas into this one
+*/
+/**************************************************************/
+void ST7558Canvas::blit(const int16_t x, const int16_t y, ST7558Canvas &canvas,
+                        const ST7558RasterOp op) {
+
+    if (canvas.getBuffer()) {
+        _blit(x, y, canvas.getBuffer(), canvas.WIDTH, canvas.HEIGHT, op, NULL, false, false);
+    }
+}
+
+void ST7558Canvas::_blit(const int16_t x, const int16_t y, const uint8_t *bitmap,
+                         const uint8_t w, const uint8_t h, const ST7558RasterOp op,
+                         const uint8_t *mask, const bool progmem, const bool invert) {
+
+    if (_buffer) {
+        ST7558Raster::blit(_buffer, WIDTH, 0, (HEIGHT - 1) / 8, HEIGHT, x, y, bitmap,
+                           w, h, op, mask, progmem, invert, _noMark);
+    }
+}
+
+/**************************************************************/
+/** @brief Draw an Adafruit_GFX (row-major, MSB left) bitmap as
+           transposed 8x8 blocks, see ST7558::drawBitmap()
+*/
+/**************************************************************/
+void ST7558Canvas::drawBitmap(const int16_t x, const int16_t y, const uint8_t bitmap[],
+                              const int16_t w, const int16_t h, const uint16_t color) {
+
+    ST7558RasterOp op;
+    bool invert;
+    if (_colorOp(color, false, op, invert)) {
+        _drawRowMajor(x, y, bitmap, w, h, op, true, invert);
+    }
+}
+
+void ST7558Canvas::drawBitmap(const int16_t x, const int16_t y, const uint8_t bitmap[],
+                              const int16_t w, const int16_t h, const uint16_t color,
+                              const uint16_t bg) {
+    _drawBitmap(x, y, bitmap, w, h, color, bg, true);
+}
+
+void ST7558Canvas::drawBitmap(const int16_t x, const int16_t y, uint8_t *bitmap,
+                              const int16_t w, const int16_t h, const uint16_t color) {
+
+    ST7558RasterOp op;
+    bool invert;
+    if (_colorOp(color, false, op, invert)) {
+        _drawRowMajor(x, y, bitmap, w, h, op, false, invert);
+    }
+}
+
+void ST7558Canvas::drawBitmap(const int16_t x, const int16_t y, uint8_t *bitmap,
+                              const int16_t w, const int16_t h, const uint16_t color,
+                              const uint16_t bg) {
+    _drawBitmap(x, y, bitmap, w, h, color, bg, false);
+}
+
+/**************************************************************/
+/** @brief This method draws an opaque row-major bitmap: one
+           COPY when the colors are a copy pair, else the
+           foreground and background passes
+*/
+/**************************************************************/
+void ST7558Canvas::_drawBitmap(const int16_t x, const int16_t y, const uint8_t *bitmap,
+                               const int16_t w, const int16_t h, const uint16_t color,
+                               const uint16_t bg, const bool progmem) {
+
+    const uint8_t fgAction = ST7558Raster::action(color, _rop);
+    const uint8_t bgAction = ST7558Raster::action(bg, _rop);
+    ST7558RasterOp op;
+    bool invert;
+    if (fgAction == bgAction) {
+        fillRect(x, y, w, h, color);
+    } else if (ST7558Raster::isCopy(fgAction, bgAction)) {
+        _drawRowMajor(x, y, bitmap, w, h, ST7558_ROP_COPY, progmem, fgAction == ST7558_DRAW_CLEAR);
+    } else {
+        if (_colorOp(color, false, op, invert)) {
+            _drawRowMajor(x, y, bitmap, w, h, op, progmem, invert);
+        }
+        if (_colorOp(bg, true, op, invert)) {
+            _drawRowMajor(x, y, bitmap, w, h, op, progmem, invert);
+        }
+    }
+}
+
+void ST7558Canvas::_drawRowMajor(const int16_t x, const int16_t y, const uint8_t *bitmap,
+                                 const int16_t w, const int16_t h, const ST7558RasterOp op,
+                                 const bool progmem, const bool invert) {
+
+    if (!_buffer) {
+        return;
+    }
+    ST7558Raster::rowMajor(x, y, bitmap, w, h, progmem, WIDTH, 0, HEIGHT,
+                           [this, op, invert](int16_t bx, int16_t by, const uint8_t *cols,
+                                              uint8_t bw, uint8_t bh) {
+        _blit(bx, by, cols, bw, bh, op, NULL, false, invert);
+    });
+}
+
+/**************************************************************/
+/** @brief Draw a character. Unscaled classic glyphs are blitted
+           as column bytes, like ST7558::drawChar(); GFXfonts and
+           scaled text go through Adafruit_GFX and the fills above
+*/
+/**************************************************************/
+void ST7558Canvas::drawChar(const int16_t x, const int16_t y, unsigned char c,
+                            const uint16_t color, const uint16_t bg,
+                            const uint8_t size_x, const uint8_t size_y) {
+
+#ifndef ST7558_NO_GLCDFONT
+    if (!gfxFont && size_x == 1 && size_y == 1) {
+
+        uint8_t cols[6];
+        ST7558Raster::glyph(c, _cp437, cols);
+        ST7558Raster::text(ST7558Raster::action(color, _rop), ST7558Raster::action(bg, _rop),
+                           bg != color,
+            [this, x, y, color]() {
+                fillRect(x, y, 6, 8, color);
+            },
+            [this, x, y, &cols](uint8_t w, ST7558RasterOp op, bool invert) {
+                _blit(x, y, cols, w, 8, op, NULL, false, invert);
+            });
+        return;
+    }
+#endif
+    Adafruit_GFX::drawChar(x, y, c, color, bg, size_x, size_y);
+}
@@ -0,0 +1,143 @@
+/**
+ * @file ST7558Canvas.h
+ *
+ * Off-screen canvas in the controller's page-major layout: pages of 8 rows,
+ * one byte per column, LSB on top, the same as the ST7558 framebuffer. It
+ * draws with the driver's byte-wide primitives (see ST7558Raster.h) and is
+ * blitted into the framebuffer, or into another canvas, as whole column
+ * bytes at any x/y, with clipping and raster ops. A GFXcanvas1 is row-major
+ * and has to be transposed on every copy.
+ *
+ * Pre-render a widget or a panel once, then composite it each frame:
+ *
+ *     ST7558Canvas panel(32, 16);
+ *     panel.drawRect(0, 0, 32, 16, BLACK);
+ *     lcd.blit(x, y, panel);
+ *
+ * Canvases are at most 255x255 pixels. Rotation is not supported.
+ *
+ * @section License
+ *
+ *  GNU GENERAL PUBLIC LICENSE ver. 3
+ *
+ */
+
+#ifndef ST7558_CANVAS_H
+#define ST7558_CANVAS_H
+
+#include "ST7558.h"
+
+class ST7558Canvas : public Adafruit_GFX {
+
+    private:
+
+        friend class ST7558;                // draws here at rotation 90/270
+
+        uint8_t *_buffer;                   // page-major, width * ((height + 7) / 8) bytes
+        bool _owned;                        // allocated by the constructor
+        ST7558RasterOp _rop;
+
+        void _fillArea(const uint8_t x0, const uint8_t x1,
+                       const uint8_t y0, const uint8_t y1,
+                       const uint16_t color);
+        void _blit(int16_t x, int16_t y, const uint8_t *bitmap,
+                   const uint8_t w, const uint8_t h, const ST7558RasterOp op,
+                   const uint8_t *mask, const bool progmem, const bool invert);
+        void _drawRowMajor(int16_t x, int16_t y, const uint8_t *bitmap,
+                           int16_t w, int16_t h, const ST7558RasterOp op,
+                           const bool progmem, const bool invert);
+        void _drawBitmap(int16_t x, int16_t y, const uint8_t *bitmap,
+                         int16_t w, int16_t h, uint16_t color,
+                         uint16_t bg, const bool progmem);
+        bool _colorOp(const uint16_t color, const bool background,
+                      ST7558RasterOp &op, bool &invert);
+
+    public:
+
+        ST7558Canvas(uint8_t w, uint8_t h);
+        ST7558Canvas(uint8_t w, uint8_t h, uint8_t *buffer);
+        ~ST7558Canvas(void);
+
+        uint8_t *getBuffer(void);
+        uint16_t getBufferSize(void);
+        uint8_t getPixel(int16_t x, int16_t y);
+
+        void setRasterOp(ST7558RasterOp op);
+        ST7558RasterOp getRasterOp(void);
+
+        void drawPixel(int16_t x, int16_t y, uint16_t color);
+
+        void drawRect(int16_t x, int16_t y, int16_t w,
+                      int16_t h, uint16_t color);
+
+        void drawRoundRect(int16_t x, int16_t y, int16_t w,
+                           int16_t h, int16_t r, uint16_t color);
+
+        void fillRoundRect(int16_t x, int16_t y, int16_t w,
+                           int16_t h, int16_t r, uint16_t color);
+
+        void drawCircle(int16_t x0, int16_t y0, int16_t r,
+                        uint16_t color);
+
+        void fillRect(int16_t x, int16_t y, int16_t w,
+                      int16_t h, uint16_t color);
+
+        void drawFastHLine(int16_t x, int16_t y, int16_t w,
+                           uint16_t color);
+
+        void drawFastVLine(int16_t x, int16_t y, int16_t h,
+                           uint16_t color);
+
+        void writeFillRect(int16_t x, int16_t y, int16_t w,
+                           int16_t h, uint16_t color);
+
+        void writeFastHLine(int16_t x, int16_t y, int16_t w,
+                            uint16_t color);
+
+        void writeFastVLine(int16_t x, int16_t y, int16_t h,
+                            uint16_t color);
+
+        void fillScreen(uint16_t color);
+
+        void scroll(int16_t x, int16_t y, int16_t w, int16_t h,
+                    int16_t dx, int16_t dy, uint16_t color = WHITE);
+
+        void scrollX(int16_t dx, uint16_t color = WHITE);
+
+        void scrollY(int16_t dy, uint16_t color = WHITE);
+
+        void blit(int16_t x, int16_t y, const uint8_t *bitmap,
+                  uint8_t w, uint8_t h,
+                  ST7558RasterOp op = ST7558_ROP_COPY,
+                  const uint8_t *mask = NULL);
+
+        void blit(int16_t x, int16_t y, uint8_t *bitmap,
+                  uint8_t w, uint8_t h,
+                  ST7558RasterOp op = ST7558_ROP_COPY,
+                  uint8_t *mask = NULL);
+
+        void blit(int16_t x, int16_t y, ST7558Canvas &canvas,
+                  ST7558RasterOp op = ST7558_ROP_COPY);
+
+        using Adafruit_GFX::drawBitmap;
+        void drawBitmap(int16_t x, int16_t y, const uint8_t bitmap[],
+                        int16_t w, int16_t h, uint16_t color);
+
+        void drawBitmap(int16_t x, int16_t y, const uint8_t bitmap[],
+                        int16_t w, int16_t h, uint16_t color,
+                        uint16_t bg);
+
+        void drawBitmap(int16_t x, int16_t y, uint8_t *bitmap,
+                        int16_t w, int16_t h, uint16_t color);
+
+        void drawBitmap(int16_t x, int16_t y, uint8_t *bitmap,
+                        int16_t w, int16_t h, uint16_t color,
+                        uint16_t bg);
+
+        using Adafruit_GFX::drawChar;
+        void drawChar(int16_t x, int16_t y, unsigned char c,
+                      uint16_t color, uint16_t bg,
+                      uint8_t size_x, uint8_t size_y);
+};
+
+#endif
@@ -0,0 +1,357 @@
+/**
+ * @file ST7558Console.cpp
+ *
+ * Text console, see ST7558Console.h
+ *
+ * @section License
+ *
+ *  GNU GENERAL PUBLIC LICENSE ver. 3
+ *
+ */
+
+#include "ST7558Console.h"
+
+#ifndef ST7558_NO_GLCDFONT
+
+#define ALL_CELLS   ((uint32_t)((1ULL << ST7558_CONSOLE_COLS) - 1))
+#define TAB_STOP    8
+
+ST7558Console::ST7558Console(ST7558 &lcd) :
+    _lcd(lcd), _top(0), _history(0), _view(0), _shift(0),
+    _col(0), _row(0), _attributes(0), _cursorVisible(false) {
+
+    memset(_text, ' ', sizeof(_text));
+    memset(_attr, 0, sizeof(_attr));
+    invalidate();
+}
+
+/**************************************************************/
+/** @brief Print one character at the cursor. '\n' starts a new
+           line, '\r' goes back to its start, '\b' one cell left
+           and '\t' to the next tab stop. A character past the
+           last column wraps, a line past the last row scrolls
+           the screen up. Output brings a scrolled back view to
+           the live screen
+*/
+/**************************************************************/
+size_t ST7558Console::write(const uint8_t c) {
+
+    if (_view) {
+        scrollBack(0);
+    }
+    _markCursor();
+    switch (c) {
+        case '\n':
+            _col = 0;
+            _newLine();
+            break;
+        case '\r':
+            _col = 0;
+            break;
+        case '\b':
+            if (_col) {
+                _col--;
+            }
+            break;
+        case '\t':
+            _col = (_col / TAB_STOP + 1) * TAB_STOP;
+            if (_col > ST7558_CONSOLE_COLS) {
+                _col = ST7558_CONSOLE_COLS;
+            }
+            break;
+        default:
+            if (_col == ST7558_CONSOLE_COLS) {
+                _col = 0;
+                _newLine();
+            }
+            _put(_col++, _row, c, _attributes);
+            break;
+    }
+    _markCursor();
+    return 1;
+}
+
+/**************************************************************/
+/** @brief Blank the screen and put the cursor home. The
+           scrollback is kept
+*/
+/**************************************************************/
+void ST7558Console::clear(void) {
+
+    if (_view) {
+        scrollBack(0);
+    }
+    _markCursor();
+    for (uint8_t row = 0; row < ST7558_CONSOLE_ROWS; row++) {
+        for (uint8_t col = 0; col < ST7558_CONSOLE_COLS; col++) {
+            _put(col, row, ' ', 0);
+        }
+    }
+    _col = _row = 0;
+    _markCursor();
+}
+
+/**************************************************************/
+/** @brief Move the cursor, clipped to the grid
+    @param  col 0..ST7558_CONSOLE_COLS - 1
+    @param  row 0..ST7558_CONSOLE_ROWS - 1
+*/
+/**************************************************************/
+void ST7558Console::setCursor(const uint8_t col, const uint8_t row) {
+
+    _markCursor();
+    _col = (col < ST7558_CONSOLE_COLS) ? col : ST7558_CONSOLE_COLS - 1;
+    _row = (row < ST7558_CONSOLE_ROWS) ? row : ST7558_CONSOLE_ROWS - 1;
+    _markCursor();
+}
+
+uint8_t ST7558Console::getCursorX(void) {
+
+    return _col;
+}
+
+uint8_t ST7558Console::getCursorY(void) {
+
+    return _row;
+}
+
+/**************************************************************/
+/** @brief Show the cursor as an inverted cell. Hidden while the
+           view is scrolled back
+*/
+/**************************************************************/
+void ST7558Console::showCursor(const bool state) {
+
+    if (state != _cursorVisible) {
+
+        _cursorVisible = true;
+        _markCursor();
+        _cursorVisible = state;
+    }
+}
+
+/**************************************************************/
+/** @brief Set the attributes of the characters printed next
+    @param  attr    ST7558_CONSOLE_INVERSE, ST7558_CONSOLE_UNDERLINE,
+                    or both
+*/
+/**************************************************************/
+void ST7558Console::setAttributes(const uint8_t attr) {
+
+    _attributes = attr;
+}
+
+uint8_t ST7558Console::getAttributes(void) {
+
+    return _attributes;
+}
+
+/**************************************************************/
+/** @brief Show older lines. The framebuffer is shifted down and
+           only the lines that come into view are redrawn
+    @param  lines   lines back, up to ST7558_CONSOLE_SCROLLBACK
+                    and to the lines printed so far. 0 - the live
+                    screen
+*/
+/**************************************************************/
+void ST7558Console::scrollBack(uint8_t lines) {
+
+    if (lines > _history) {
+        lines = _history;
+    }
+    if (lines == _view) {
+        return;
+    }
+    _markCursor();
+    const int8_t delta = lines - _view;
+    _view = lines;
+    _scroll(-delta, ALL_CELLS);
+    _markCursor();
+}
+
+uint8_t ST7558Console::getScrollBack(void) {
+
+    return _view;
+}
+
+/**************************************************************/
+/** @brief Redraw every cell with the next render(), e.g. after
+           drawing over the console with the GFX functions
+*/
+/**************************************************************/
+void ST7558Console::invalidate(void) {
+
+    for (uint8_t row = 0; row < ST7558_CONSOLE_ROWS; row++) {
+        _dirty[row] = ALL_CELLS;
+    }
+}
+
+/**************************************************************/
+/** @brief Catch the framebuffer up with the text: do the pending
+           scroll, then draw the changed cells, a run of
+           neighbours per blit. Call display() after it. In strip
+           mode every cell is drawn every pass, call it inside
+           the page loop
+    @return number of cells drawn
+*/
+/**************************************************************/
+uint8_t ST7558Console::render(void) {
+
+    uint8_t run[ST7558_CONSOLE_COLS * 6];
+    uint8_t drawn = 0;
+
+#ifndef ST7558_STRIP_PAGES
+    if (_shift) {
+        _lcd.scroll(0, 0, ST7558_CONSOLE_COLS * 6, ST7558_CONSOLE_ROWS * 8, 0, -8 * _shift);
+        _shift = 0;
+    }
+#endif
+    for (uint8_t row = 0; row < ST7558_CONSOLE_ROWS; row++) {
+
+    #ifdef ST7558_STRIP_PAGES
+        const uint32_t dirty = ALL_CELLS;
+    #else
+        const uint32_t dirty = _dirty[row];
+        _dirty[row] = 0;
+    #endif
+        uint8_t col = 0;
+        while (col < ST7558_CONSOLE_COLS) {
+
+            if (!(dirty & (1UL << col))) {
+                col++;
+                continue;
+            }
+            const uint8_t start = col;
+            for (; col < ST7558_CONSOLE_COLS && (dirty & (1UL << col)); col++) {
+                _cell(col, row, &run[(col - start) * 6]);
+            }
+            _lcd.blit(start * 6, row * 8, run, (col - start) * 6, 8, ST7558_ROP_COPY);
+            drawn += col - start;
+        }
+    }
+    return drawn;
+}
+
+/**************************************************************/
+/** @brief This method returns the ring line shown on a screen
+           row
+*/
+/**************************************************************/
+uint8_t ST7558Console::_line(const uint8_t row) {
+
+    return (_top + ST7558_CONSOLE_LINES + row - _view) % ST7558_CONSOLE_LINES;
+}
+
+/**************************************************************/
+/** @brief This method stores a cell of the live screen, marking
+           it only if it changes
+*/
+/**************************************************************/
+void ST7558Console::_put(const uint8_t col, const uint8_t row,
+                         const uint8_t c, const uint8_t attr) {
+
+    const uint8_t line = _line(row);
+    if (_text[line][col] != c || _attr[line][col] != attr) {
+
+        _text[line][col] = c;
+        _attr[line][col] = attr;
+        _dirty[row] |= 1UL << col;
+    }
+}
+
+/**************************************************************/
+/** @brief This method marks the cell the cursor is drawn on
+*/
+/**************************************************************/
+void ST7558Console::_markCursor(void) {
+
+    if (_cursorVisible && !_view && _col < ST7558_CONSOLE_COLS) {
+        _dirty[_row] |= 1UL << _col;
+    }
+}
+
+/**************************************************************/
+/** @brief This method moves the cursor a row down, scrolling the
+           screen up from the last row. The oldest scrollback line
+           becomes the new, blank, last row
+*/
+/**************************************************************/
+void ST7558Console::_newLine(void) {
+
+    if (_row + 1 < ST7558_CONSOLE_ROWS) {
+        _row++;
+        return;
+    }
+    _top = (_top + 1) % ST7558_CONSOLE_LINES;
+    if (_history < ST7558_CONSOLE_SCROLLBACK) {
+        _history++;
+    }
+    const uint8_t line = _line(ST7558_CONSOLE_ROWS - 1);
+    memset(_text[line], ' ', ST7558_CONSOLE_COLS);
+    memset(_attr[line], 0, ST7558_CONSOLE_COLS);
+    // the strip scroll() exposes is white, already a row of blanks
+    _scroll(1, 0);
+}
+
+/**************************************************************/
+/** @brief This method records a framebuffer shift for render()
+           and moves the dirty bits with the rows. Shifts one way
+           add up; a shift the other way first has the pending
+           one done, as rows pushed out would come back stale
+    @param  lines   up, negative down
+    @param  exposed dirty bits of the rows the shift exposes
+*/
+/**************************************************************/
+void ST7558Console::_scroll(const int8_t lines, const uint32_t exposed) {
+
+#ifdef ST7558_STRIP_PAGES
+    (void)lines;
+    (void)exposed;
+#else
+    if ((_shift > 0 && lines < 0) || (_shift < 0 && lines > 0)) {
+        _lcd.scroll(0, 0, ST7558_CONSOLE_COLS * 6, ST7558_CONSOLE_ROWS * 8, 0, -8 * _shift);
+        _shift = 0;
+    }
+    _shift += lines;
+    if (_shift > ST7558_CONSOLE_ROWS) {
+        _shift = ST7558_CONSOLE_ROWS;
+    } else if (_shift < -ST7558_CONSOLE_ROWS) {
+        _shift = -ST7558_CONSOLE_ROWS;
+    }
+
+    if (lines > 0) {
+        for (uint8_t row = 0; row < ST7558_CONSOLE_ROWS; row++) {
+            _dirty[row] = (row + lines < ST7558_CONSOLE_ROWS) ? _dirty[row + lines] : exposed;
+        }
+    } else {
+        for (uint8_t row = ST7558_CONSOLE_ROWS; row-- > 0;) {
+            _dirty[row] = (row >= -lines) ? _dirty[row + lines] : exposed;
+        }
+    }
+#endif
+}
+
+/**************************************************************/
+/** @brief This method builds a cell's 6 column bytes: the glyph,
+           then its attributes and the cursor
+*/
+/**************************************************************/
+void ST7558Console::_cell(const uint8_t col, const uint8_t row, uint8_t *out) {
+
+    const uint8_t line = _line(row);
+    const uint8_t attr = _attr[line][col];
+    const bool cursor = _cursorVisible && !_view && col == _col && row == _row;
+
+    ST7558Raster::glyph(_text[line][col], out);
+    for (uint8_t i = 0; i < 6; i++) {
+
+        if (attr & ST7558_CONSOLE_UNDERLINE) {
+            out[i] |= 0x80;
+        }
+        if (((attr & ST7558_CONSOLE_INVERSE) != 0) != cursor) {
+            out[i] = ~out[i];
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,93 @@
+/**
+ * @file ST7558Console.h
+ *
+ * Text console for the ST7558 driver: a grid of 6x8 cells in the classic
+ * font (16x8 on the C115 panel) with line wrap, scrolling, a cursor and a
+ * small scrollback. It is a Print, so print() and println() work on it.
+ * Each cell keeps a dirty bit: render() redraws only the cells whose
+ * character or attributes changed, as page-aligned column bytes. A new
+ * line shifts the framebuffer with ST7558::scroll() instead of redrawing
+ * the lines above it, so a log costs its new characters on the bus.
+ *
+ *     ST7558Console console(lcd);
+ *     console.println("boot ok");
+ *     console.render();
+ *     lcd.display();
+ *
+ * Needs the classic font, not available with ST7558_NO_GLCDFONT.
+ *
+ * @section License
+ *
+ *  GNU GENERAL PUBLIC LICENSE ver. 3
+ *
+ */
+
+#ifndef ST7558_CONSOLE_H
+#define ST7558_CONSOLE_H
+
+#include "ST7558.h"
+
+#ifndef ST7558_NO_GLCDFONT
+
+#define ST7558_CONSOLE_COLS     (ST7558_WIDTH / 6)
+#define ST7558_CONSOLE_ROWS     (ST7558_HEIGHT / 8)
+
+// lines kept above the screen for scrollBack(), 2 * ST7558_CONSOLE_COLS
+// bytes of RAM each
+#ifndef ST7558_CONSOLE_SCROLLBACK
+    #define ST7558_CONSOLE_SCROLLBACK   4
+#endif
+#define ST7558_CONSOLE_LINES    (ST7558_CONSOLE_ROWS + ST7558_CONSOLE_SCROLLBACK)
+
+// cell attributes
+#define ST7558_CONSOLE_INVERSE      0x01    // white on black
+#define ST7558_CONSOLE_UNDERLINE    0x02    // bottom row of the cell set
+
+class ST7558Console : public Print {
+
+    private:
+
+        ST7558 &_lcd;
+        uint8_t _text[ST7558_CONSOLE_LINES][ST7558_CONSOLE_COLS];   // a ring of lines
+        uint8_t _attr[ST7558_CONSOLE_LINES][ST7558_CONSOLE_COLS];
+        uint32_t _dirty[ST7558_CONSOLE_ROWS];   // one bit per cell of a screen row
+        uint8_t _top;                       // ring line shown on the first row
+        uint8_t _history;                   // lines above it that can be viewed
+        uint8_t _view;                      // lines the view is scrolled back
+        int8_t _shift;                      // framebuffer shift not done yet, in lines, + is up
+        uint8_t _col, _row;                 // cursor, _col == ST7558_CONSOLE_COLS - wrap due
+        uint8_t _attributes;                // for the next characters
+        bool _cursorVisible;
+
+        uint8_t _line(uint8_t row);
+        void _put(uint8_t col, uint8_t row, uint8_t c, uint8_t attr);
+        void _markCursor(void);
+        void _newLine(void);
+        void _scroll(int8_t lines, uint32_t exposed);
+        void _cell(uint8_t col, uint8_t row, uint8_t *out);
+
+    public:
+
+        ST7558Console(ST7558 &lcd);
+
+        using Print::write;
+        size_t write(uint8_t c);
+
+        void clear(void);
+        void setCursor(uint8_t col, uint8_t row);
+        uint8_t getCursorX(void);
+        uint8_t getCursorY(void);
+        void showCursor(bool state);
+
+        void setAttributes(uint8_t attr);
+        uint8_t getAttributes(void);
+
+        void scrollBack(uint8_t lines);
+        uint8_t getScrollBack(void);
+
+        void invalidate(void);
+        uint8_t render(void);
+};
+
+#endif
+#endif
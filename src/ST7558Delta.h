@@ -0,0 +1,205 @@
+/**
+ * @file ST7558Delta.h
+ *
+ * Delta coding of page-major frames, shared by the frame recorder
+ * (ST7558::startRecording()), the animation player (ST7558Animation) and
+ * the host tools in extras/host.
+ *
+ * A stream is a header, magic, version, width and height, then one record
+ * per frame: mark, frame number (2 bytes) and millis() (4 bytes, both
+ * little-endian), then the XOR of the frame with the one before,
+ * page-major and run-length coded, then END. A run code holds its type in
+ * the top 2 bits and its length - 1 in the low 6. A key frame is coded
+ * against a blank frame, so playback can start or loop there; a recording
+ * starts with one.
+ *
+ * @section License
+ *
+ *  GNU GENERAL PUBLIC LICENSE ver. 3
+ *
+ */
+
+#ifndef ST7558_DELTA_H
+#define ST7558_DELTA_H
+
+#include "ST7558Raster.h"
+
+#define ST7558_REC_MAGIC        0xB7
+#define ST7558_REC_VERSION      1
+#define ST7558_REC_KEY          0xFD        // key frame record mark
+#define ST7558_REC_FRAME        0xFE        // frame record mark
+#define ST7558_REC_END          0xFF        // end of frame, the rest is unchanged
+#define ST7558_REC_SKIP         0x00        // n bytes unchanged
+#define ST7558_REC_REPEAT       0x40        // + 1 byte: n bytes XORed with it
+#define ST7558_REC_LITERAL      0x80        // + n bytes to XOR with
+#define ST7558_REC_RUN          64          // longest run
+#define ST7558_REC_HEADER       4           // stream header bytes
+#define ST7558_REC_RECORD       7           // record mark and header bytes
+
+// Codes one record to a Print. Codes are gathered and handed to the sink
+// a few dozen bytes at a time. The record header is held until the first
+// change, so a frame equal to the last one costs nothing
+class ST7558DeltaWriter {
+
+    private:
+
+        Print &_sink;
+        uint8_t _out[32];
+        uint8_t _count;
+        uint8_t _literal[ST7558_REC_RUN];
+        uint8_t _literalCount;
+        uint16_t _skip;                     // unchanged bytes not coded yet
+        uint16_t _pos;                      // next frame byte to code
+        uint8_t _head[ST7558_REC_RECORD];
+        bool _open;                         // header written
+
+        void _put(const uint8_t b) {
+
+            if (!_open) {
+                _open = true;
+                for (uint8_t i = 0; i < ST7558_REC_RECORD; i++) {
+                    _put(_head[i]);
+                }
+            }
+            if (_count == sizeof(_out)) {
+                flush();
+            }
+            _out[_count++] = b;
+        }
+
+        void _endLiteral(void) {
+
+            if (_literalCount) {
+                _put(ST7558_REC_LITERAL | (_literalCount - 1));
+                for (uint8_t i = 0; i < _literalCount; i++) {
+                    _put(_literal[i]);
+                }
+                _literalCount = 0;
+            }
+        }
+
+        void _endSkip(void) {
+
+            while (_skip) {
+                const uint8_t n = (_skip < ST7558_REC_RUN) ? _skip : ST7558_REC_RUN;
+                _put(ST7558_REC_SKIP | (n - 1));
+                _skip -= n;
+            }
+        }
+
+        void _changed(const uint8_t delta) {
+
+            _endSkip();
+            if (_literalCount == ST7558_REC_RUN) {
+                _endLiteral();
+            }
+            _literal[_literalCount++] = delta;
+        }
+
+        void _repeat(const uint8_t delta, const uint8_t n) {
+
+            _endLiteral();
+            _endSkip();
+            _put(ST7558_REC_REPEAT | (n - 1));
+            _put(delta);
+        }
+
+    public:
+
+        ST7558DeltaWriter(Print &sink, const uint8_t mark,
+                          const uint16_t index, const uint32_t millis) :
+            _sink(sink), _count(0), _literalCount(0), _skip(0), _pos(0), _open(false) {
+
+            _head[0] = mark;
+            _head[1] = index;
+            _head[2] = index >> 8;
+            for (uint8_t i = 0; i < 4; i++) {
+                _head[3 + i] = millis >> (8 * i);
+            }
+        }
+
+        /**************************************************************/
+        /** @brief Write the stream header
+        */
+        /**************************************************************/
+        static void header(Print &sink, const uint8_t width, const uint8_t height) {
+
+            const uint8_t head[ST7558_REC_HEADER] = { ST7558_REC_MAGIC, ST7558_REC_VERSION,
+                                                      width, height };
+            sink.write(head, sizeof(head));
+        }
+
+        /**************************************************************/
+        /** @brief Code frame bytes i..end, after the ones coded so
+                   far: each is XORed with the reference, which takes
+                   the new byte. Runs of the same delta are coded as
+                   one repeat, the rest as literals
+        */
+        /**************************************************************/
+        void code(const uint8_t *src, const bool progmem, uint8_t *ref,
+                  uint16_t i, const uint16_t end) {
+
+            _endLiteral();
+            _skip += i - _pos;
+            while (i <= end) {
+
+                uint8_t b = ST7558Raster::readByte(&src[i], progmem);
+                const uint8_t delta = b ^ ref[i];
+                if (!delta) {
+                    _endLiteral();
+                    _skip++;
+                    i++;
+                    continue;
+                }
+                ref[i] = b;
+                uint8_t n = 1;
+                while (i + n <= end && n < ST7558_REC_RUN) {
+
+                    b = ST7558Raster::readByte(&src[i + n], progmem);
+                    if ((b ^ ref[i + n]) != delta) {
+                        break;
+                    }
+                    ref[i + n] = b;
+                    n++;
+                }
+                if (n >= 3) {
+                    _repeat(delta, n);
+                } else {
+                    for (uint8_t k = 0; k < n; k++) {
+                        _changed(delta);
+                    }
+                }
+                i += n;
+            }
+            _pos = end + 1;
+        }
+
+        /**************************************************************/
+        /** @brief End the record. A trailing unchanged run goes
+                   unsaid
+            @param  always  write the record even if nothing changed,
+                            e.g. a blank key frame
+            @return true if the record was written
+        */
+        /**************************************************************/
+        bool finish(const bool always) {
+
+            _endLiteral();
+            if (!_open && !always) {
+                return false;
+            }
+            _put(ST7558_REC_END);
+            flush();
+            return true;
+        }
+
+        void flush(void) {
+
+            if (_count) {
+                _sink.write(_out, _count);
+                _count = 0;
+            }
+        }
+};
+
+#endif
@@ -0,0 +1,716 @@
+/**
+ * @file ST7558Raster.h
+ *
+ * Page-major raster core shared by ST7558 and ST7558Canvas. A page-major
+ * bitmap is a run of pages, 8 rows each, of one byte per column with the
+ * LSB on top: the layout of the controller's display RAM.
+ *
+ * The kernels take the target's geometry as arguments and are inlined into
+ * their callers. ST7558 passes its compile-time panel size, so bounds and
+ * page counts still fold into constants there, and a canvas passes its own.
+ * Only glyph() is out of line: the classic font lives in ST7558.cpp.
+ * Callers that track changes pass a functor called once per page touched,
+ * as mark(page, x0, x1, ink). The outline and text helpers only decide
+ * what to draw, and call back into the caller's fills and pixels, so both
+ * classes draw the same shapes.
+ *
+ * @section License
+ *
+ *  GNU GENERAL PUBLIC LICENSE ver. 3
+ *
+ */
+
+#ifndef ST7558_RASTER_H
+#define ST7558_RASTER_H
+
+#if defined(ARDUINO) && ARDUINO >= 100
+    #include "Arduino.h"
+#else
+    #include "WProgram.h"
+#endif
+#ifdef __AVR__
+    #include <avr/pgmspace.h>
+#elif defined(ESP8266) || defined(ESP32)
+    #include <pgmspace.h>
+#endif
+
+#define BLACK 1
+#define WHITE 0
+#define INVERSE 2                           // flip the pixels drawn, whatever the raster op
+
+// how blitted bits combine with the framebuffer, inside the bitmap mask
+enum ST7558RasterOp {
+
+    ST7558_ROP_COPY,                        // dst = src
+    ST7558_ROP_OR,                          // dst |= src
+    ST7558_ROP_AND,                         // dst &= src
+    ST7558_ROP_XOR,                         // dst ^= src
+    ST7558_ROP_NOT                          // dst = ~src
+};
+
+// what a color does to the pixels it is drawn on, after the raster op
+#define ST7558_DRAW_NONE    0
+#define ST7558_DRAW_SET     1
+#define ST7558_DRAW_CLEAR   2
+#define ST7558_DRAW_FLIP    3
+
+#define ST7558_RASTER_BLOCKS    14          // 8x8 blocks transposed per blit of a row-major band
+
+class ST7558Raster {
+
+    public:
+
+        static uint8_t readByte(const uint8_t *p, const bool progmem) {
+            return progmem ? pgm_read_byte(p) : *p;
+        }
+
+#ifndef ST7558_NO_GLCDFONT
+        static void glyph(uint8_t c, uint8_t *cols);
+
+        /**************************************************************/
+        /** @brief Same as above, with Adafruit_GFX's legacy glyph
+                   order unless cp437 is set: it skips one glyph
+                   from 176 on
+        */
+        /**************************************************************/
+        static void glyph(const uint8_t c, const bool cp437, uint8_t *cols) {
+            glyph((!cp437 && c >= 176) ? (uint8_t)(c + 1) : c, cols);
+        }
+#endif
+
+        /**************************************************************/
+        /** @brief Turn a color into what it does to the pixels
+                   drawn under a raster op
+        */
+        /**************************************************************/
+        static uint8_t action(const uint16_t color, const ST7558RasterOp rop) {
+
+            if (color == INVERSE) {
+                return ST7558_DRAW_FLIP;
+            }
+            switch (rop) {
+                case ST7558_ROP_OR:   return color ? ST7558_DRAW_SET : ST7558_DRAW_NONE;
+                case ST7558_ROP_AND:  return color ? ST7558_DRAW_NONE : ST7558_DRAW_CLEAR;
+                case ST7558_ROP_XOR:  return color ? ST7558_DRAW_FLIP : ST7558_DRAW_NONE;
+                case ST7558_ROP_NOT:  return color ? ST7558_DRAW_CLEAR : ST7558_DRAW_SET;
+                default:              return color ? ST7558_DRAW_SET : ST7558_DRAW_CLEAR;
+            }
+        }
+
+        /**************************************************************/
+        /** @brief Pick the blit op for an action on the set bits of a
+                   source, or on its clear bits with background set
+            @return false if the action leaves the pixels as they are
+        */
+        /**************************************************************/
+        static bool colorOp(const uint8_t action, const bool background,
+                            ST7558RasterOp &op, bool &invert) {
+
+            switch (action) {
+                case ST7558_DRAW_SET:   op = ST7558_ROP_OR;  invert = background; return true;
+                case ST7558_DRAW_CLEAR: op = ST7558_ROP_AND; invert = !background; return true;
+                case ST7558_DRAW_FLIP:  op = ST7558_ROP_XOR; invert = background; return true;
+                default:                return false;
+            }
+        }
+
+        /**************************************************************/
+        /** @brief Check for a foreground/background pair that is one
+                   COPY of the source (or of its inverse)
+        */
+        /**************************************************************/
+        static bool isCopy(const uint8_t fg, const uint8_t bg) {
+            return (fg == ST7558_DRAW_SET && bg == ST7558_DRAW_CLEAR) ||
+                   (fg == ST7558_DRAW_CLEAR && bg == ST7558_DRAW_SET);
+        }
+
+        /**************************************************************/
+        /** @brief Draw a 6x8 classic glyph cell from the actions of
+                   its colors: one fill if both do the same, one COPY
+                   of the columns if they are a set/clear pair, else
+                   the foreground on the five glyph columns and the
+                   background on all six. Calls fill() for the cell,
+                   or columns(w, op, invert)
+            @param  opaque  bg differs from color, else the text is
+                            transparent
+        */
+        /**************************************************************/
+        template <class Fill, class Columns>
+        static void text(const uint8_t fgAction, const uint8_t bgAction,
+                         const bool opaque, Fill fill, Columns columns) {
+
+            if (opaque && fgAction == bgAction) {
+                fill();
+                return;
+            }
+            if (opaque && isCopy(fgAction, bgAction)) {
+                columns(6, ST7558_ROP_COPY, fgAction == ST7558_DRAW_CLEAR);
+                return;
+            }
+            ST7558RasterOp op;
+            bool invert;
+            if (colorOp(fgAction, false, op, invert)) {
+                columns(5, op, invert);
+            }
+            if (opaque && colorOp(bgAction, true, op, invert)) {
+                columns(6, op, invert);
+            }
+        }
+
+        /**************************************************************/
+        /** @brief Transpose an 8x8 bit block: eight row bytes (MSB
+                   left) in, eight column bytes (LSB on top) out.
+                   Hacker's Delight transpose8, fed bottom row first
+        */
+        /**************************************************************/
+        static void transpose8(const uint8_t *rows, uint8_t *cols) {
+
+            uint32_t x = ((uint32_t)rows[7] << 24) | ((uint32_t)rows[6] << 16) |
+                         ((uint32_t)rows[5] << 8) | rows[4];
+            uint32_t y = ((uint32_t)rows[3] << 24) | ((uint32_t)rows[2] << 16) |
+                         ((uint32_t)rows[1] << 8) | rows[0];
+            uint32_t t;
+
+            t = (x ^ (x >> 7)) & 0x00AA00AA;  x = x ^ t ^ (t << 7);
+            t = (y ^ (y >> 7)) & 0x00AA00AA;  y = y ^ t ^ (t << 7);
+            t = (x ^ (x >> 14)) & 0x0000CCCC; x = x ^ t ^ (t << 14);
+            t = (y ^ (y >> 14)) & 0x0000CCCC; y = y ^ t ^ (t << 14);
+            t = (x & 0xF0F0F0F0) | ((y >> 4) & 0x0F0F0F0F);
+            y = ((x << 4) & 0xF0F0F0F0) | (y & 0x0F0F0F0F);
+            x = t;
+
+            cols[0] = x >> 24; cols[1] = x >> 16; cols[2] = x >> 8; cols[3] = x;
+            cols[4] = y >> 24; cols[5] = y >> 16; cols[6] = y >> 8; cols[7] = y;
+        }
+
+        /**************************************************************/
+        /** @brief Convert a row-major bitmap (Adafruit_GFX format,
+                   MSB left) to page-major, 8x8 blocks at a time
+            @param  out     w * ((h + 7) / 8) bytes
+        */
+        /**************************************************************/
+        static void toPageMajor(const uint8_t *bitmap, const uint8_t w, const uint8_t h,
+                                uint8_t *out, const bool progmem) {
+
+            const uint8_t stride = (w + 7) / 8;
+            uint8_t rows[8], cols[8];
+
+            for (uint8_t r = 0; r < h; r += 8) {
+                for (uint8_t b = 0; b < stride; b++) {
+
+                    for (uint8_t j = 0; j < 8; j++) {
+                        rows[j] = (r + j < h) ? readByte(&bitmap[(r + j) * stride + b], progmem) : 0;
+                    }
+                    transpose8(rows, cols);
+
+                    const uint8_t n = (w - b * 8 < 8) ? w - b * 8 : 8;
+                    memcpy(&out[(r / 8) * w + b * 8], cols, n);
+                }
+            }
+        }
+
+        /**************************************************************/
+        /** @brief Fill an already clipped area. The first and last
+                   pages get head/tail bit masks, whole pages in
+                   between are plain memset
+            @param  buffer  page 'first' of the target at buffer[0]
+            @param  stride  target width
+        */
+        /**************************************************************/
+        template <class Mark>
+        static void fill(uint8_t *buffer, const uint8_t stride, const uint8_t first,
+                         const uint8_t x0, const uint8_t x1,
+                         const uint8_t y0, const uint8_t y1,
+                         const uint8_t action, Mark mark) {
+
+            const uint8_t n = x1 - x0 + 1;
+            const uint8_t last = y1 / 8;
+            uint8_t bits = 0xFF << (y0 % 8);
+
+            for (uint8_t page = y0 / 8; page <= last; page++) {
+
+                if (page == last) {
+                    bits &= 0xFF >> (7 - y1 % 8);
+                }
+
+                uint8_t *p = &buffer[stride * (page - first) + x0];
+                if (action == ST7558_DRAW_FLIP) {
+                    for (uint8_t i = 0; i < n; i++) {
+                        p[i] ^= bits;
+                    }
+                } else if (bits == 0xFF) {
+                    memset(p, action == ST7558_DRAW_SET ? 0xFF : 0x00, n);
+                } else if (action == ST7558_DRAW_SET) {
+                    for (uint8_t i = 0; i < n; i++) {
+                        p[i] |= bits;
+                    }
+                } else {
+                    for (uint8_t i = 0; i < n; i++) {
+                        p[i] &= ~bits;
+                    }
+                }
+                mark(page, x0, x1, action != ST7558_DRAW_CLEAR);
+                bits = 0xFF;
+            }
+        }
+
+        /**************************************************************/
+        /** @brief Shift an already clipped area by dx columns and dy
+                   rows, filling what is exposed with 'fill'. Pixels
+                   outside the area are kept. Columns move a page row
+                   at a time with memmove. Rows move down a column as
+                   16-bit words of two adjacent pages, so the bits
+                   that cross a page boundary carry over in one shift.
+                   A vertical shift marks only the columns that
+                   really changed, so blank margins stay clean
+            @param  stride  target width
+            @param  fill    0x00 or 0xFF
+        */
+        /**************************************************************/
+        template <class Mark>
+        static void scroll(uint8_t *buffer, const uint8_t stride,
+                           const uint8_t x0, const uint8_t x1,
+                           const uint8_t y0, const uint8_t y1,
+                           const int16_t dx, const int16_t dy,
+                           const uint8_t fill, Mark mark) {
+
+            const uint8_t n = x1 - x0 + 1;
+            const uint8_t first = y0 / 8, last = y1 / 8;
+            const uint8_t headBits = 0xFF << (y0 % 8);
+            const uint8_t tailBits = 0xFF >> (7 - y1 % 8);
+            uint8_t changedMin[32], changedMax[32];      // per page, from x0
+
+            for (uint8_t page = first; page <= last; page++) {
+                changedMin[page] = dx ? 0 : 0xFF;
+                changedMax[page] = dx ? n - 1 : 0;
+            }
+
+            if (dx) {
+
+                const uint8_t k = (dx > -n && dx < n) ? (dx < 0 ? -dx : dx) : n;
+                for (uint8_t page = first; page <= last; page++) {
+
+                    const uint8_t bits = (page == first ? headBits : 0xFF) &
+                                         (page == last ? tailBits : 0xFF);
+                    uint8_t *p = &buffer[stride * page + x0];
+                    if (bits == 0xFF) {
+                        if (dx > 0) {
+                            memmove(p + k, p, n - k);
+                            memset(p, fill, k);
+                        } else {
+                            memmove(p, p + k, n - k);
+                            memset(p + n - k, fill, k);
+                        }
+                    } else if (dx > 0) {
+                        for (uint8_t i = n; i-- > 0;) {
+                            const uint8_t s = (i >= k) ? p[i - k] : fill;
+                            p[i] = (p[i] & ~bits) | (s & bits);
+                        }
+                    } else {
+                        for (uint8_t i = 0; i < n; i++) {
+                            const uint8_t s = (i + k < n) ? p[i + k] : fill;
+                            p[i] = (p[i] & ~bits) | (s & bits);
+                        }
+                    }
+                }
+            }
+
+            if (dy) {
+
+                // page 'page' takes the word of source pages hi:lo
+                const int16_t pages = (dy < 0 ? -dy : dy) / 8;
+                const uint8_t shift = (dy < 0 ? -dy : dy) % 8;
+                const bool down = dy > 0;
+                const int8_t step = down ? -1 : 1;
+                int16_t page = down ? last : first;
+                for (uint8_t j = first; j <= last; j++, page += step) {
+
+                    const uint8_t bits = (page == first ? headBits : 0xFF) &
+                                         (page == last ? tailBits : 0xFF);
+                    const int16_t hi = down ? page - pages : page + pages + 1;
+                    const int16_t lo = down ? page - pages - 1 : page + pages;
+                    const bool hasHi = hi >= first && hi <= last;
+                    const bool hasLo = lo >= first && lo <= last;
+                    uint8_t *p = &buffer[stride * page + x0];
+                    uint8_t &cmin = changedMin[page], &cmax = changedMax[page];
+
+                    // a missing source page is read through an empty mask
+                    const uint8_t hiBits = !hasHi ? 0 : (hi == first ? headBits : 0xFF) &
+                                                        (hi == last ? tailBits : 0xFF);
+                    const uint8_t loBits = !hasLo ? 0 : (lo == first ? headBits : 0xFF) &
+                                                        (lo == last ? tailBits : 0xFF);
+                    const uint8_t *h = hasHi ? &buffer[stride * hi + x0] : p;
+                    const uint8_t *l = hasLo ? &buffer[stride * lo + x0] : p;
+
+                    // whole pages move as rows of bytes, equal ends are skipped
+                    const uint8_t srcBits = down ? hiBits : loBits;
+                    if (!shift && bits == 0xFF && (srcBits == 0xFF || !srcBits)) {
+
+                        const uint8_t *src = down ? h : l;
+                        uint8_t i0 = 0, i1 = n;
+                        while (i0 < i1 && p[i0] == (srcBits ? src[i0] : fill)) {
+                            i0++;
+                        }
+                        while (i1 > i0 && p[i1 - 1] == (srcBits ? src[i1 - 1] : fill)) {
+                            i1--;
+                        }
+                        if (i0 < i1) {
+                            if (srcBits) {
+                                memcpy(p + i0, src + i0, i1 - i0);
+                            } else {
+                                memset(p + i0, fill, i1 - i0);
+                            }
+                            cmin = (i0 < cmin) ? i0 : cmin;
+                            cmax = (i1 - 1 > cmax) ? i1 - 1 : cmax;
+                        }
+                        continue;
+                    }
+
+                    // rows outside the area read as the fill
+                    const uint8_t hiFill = fill & ~hiBits;
+                    const uint8_t loFill = fill & ~loBits;
+                    for (uint8_t i = 0; i < n; i++) {
+
+                        const uint16_t word = ((uint16_t)((h[i] & hiBits) | hiFill) << 8) |
+                                              (l[i] & loBits) | loFill;
+                        const uint8_t s = down ? (uint16_t)(word << shift) >> 8 : word >> shift;
+                        const uint8_t d = (p[i] & ~bits) | (s & bits);
+                        if (d != p[i]) {
+                            p[i] = d;
+                            cmin = (i < cmin) ? i : cmin;
+                            cmax = (i > cmax) ? i : cmax;
+                        }
+                    }
+                }
+            }
+
+            for (uint8_t page = first; page <= last; page++) {
+                if (changedMin[page] != 0xFF) {
+                    mark(page, x0 + changedMin[page], x0 + changedMax[page], true);
+                }
+            }
+        }
+
+        /**************************************************************/
+        /** @brief Blit a page-major bitmap at any x/y. For every page
+                   it touches the two source pages that land on it
+                   are combined into one byte per column, so each
+                   target byte is read and written once. Rows below
+                   h, rows outside the target and rows outside the
+                   mask are kept. Only columns that really changed
+                   are marked
+            @param  buffer  page 'first' of the target at buffer[0]
+            @param  stride  target width
+            @param  first   first page held in buffer
+            @param  last    last page held in buffer
+            @param  height  target height in rows
+        */
+        /**************************************************************/
+        template <class Mark>
+        static void blit(uint8_t *buffer, const uint8_t stride,
+                         const uint8_t first, const uint8_t last, const uint8_t height,
+                         const int16_t x, const int16_t y, const uint8_t *bitmap,
+                         const uint8_t w, const uint8_t h, const ST7558RasterOp op,
+                         const uint8_t *mask, const bool progmem, const bool invert,
+                         Mark mark) {
+
+            const int16_t clipTop = first * 8;
+            const int16_t clipBottom = ((last + 1) * 8 < height) ? (last + 1) * 8 : height;
+            if (!w || !h || y >= clipBottom || y + h <= clipTop) {
+                return;
+            }
+
+            // clip columns once
+            const int16_t c0 = (x < 0) ? -x : 0;
+            const int16_t c1 = (x + w > stride) ? stride - 1 - x : w - 1;
+            if (c0 > c1) {
+                return;
+            }
+            const uint8_t x0 = x + c0;
+            const uint8_t n = c1 - c0 + 1;
+
+            const uint8_t srcPages = (h + 7) / 8;
+            const int16_t top = (y >= 0) ? y / 8 : -((7 - y) / 8);     // floor(y / 8)
+            const uint8_t shift = y - top * 8;
+            const uint8_t tail = 0xFF >> ((8 - h % 8) % 8);           // rows of the last source page
+            const int16_t from = (top < first) ? first : top;
+            const int16_t to = ((y + h - 1) / 8 < last) ? (y + h - 1) / 8 : last;
+
+            for (int16_t page = from; page <= to; page++) {
+
+                // source page k lands here shifted down, page k - 1 spills over
+                const int16_t k = page - top;
+                const bool hasLo = k < srcPages;
+                const bool hasHi = shift && k > 0;
+                const uint16_t lo = k * w + c0;
+                const uint16_t hi = (k - 1) * w + c0;
+
+                uint8_t rows = 0;
+                if (hasLo) {
+                    rows |= (uint8_t)((k == srcPages - 1 ? tail : 0xFF) << shift);
+                }
+                if (hasHi) {
+                    rows |= (k - 1 == srcPages - 1 ? tail : 0xFF) >> (8 - shift);
+                }
+                if ((page + 1) * 8 > height) {
+                    rows &= 0xFF >> ((page + 1) * 8 - height);
+                }
+
+                uint8_t *dst = &buffer[stride * (page - first) + x0];
+                uint8_t changedMin = 0xFF, changedMax = 0;
+                for (uint8_t i = 0; i < n; i++) {
+
+                    uint8_t s = 0;
+                    uint8_t m = rows;
+                    if (hasLo) {
+                        s = readByte(&bitmap[lo + i], progmem) << shift;
+                    }
+                    if (hasHi) {
+                        s |= readByte(&bitmap[hi + i], progmem) >> (8 - shift);
+                    }
+                    if (invert) {
+                        s = ~s;
+                    }
+                    if (mask) {
+                        uint8_t t = 0;
+                        if (hasLo) {
+                            t = readByte(&mask[lo + i], progmem) << shift;
+                        }
+                        if (hasHi) {
+                            t |= readByte(&mask[hi + i], progmem) >> (8 - shift);
+                        }
+                        m &= t;
+                    }
+
+                    const uint8_t old = dst[i];
+                    uint8_t d = old;
+                    switch (op) {
+                        case ST7558_ROP_COPY: d = (d & ~m) | (s & m); break;
+                        case ST7558_ROP_OR:   d |= s & m; break;
+                        case ST7558_ROP_AND:  d &= s | ~m; break;
+                        case ST7558_ROP_XOR:  d ^= s & m; break;
+                        case ST7558_ROP_NOT:  d = (d & ~m) | (~s & m); break;
+                    }
+                    if (d != old) {
+                        dst[i] = d;
+                        if (changedMin == 0xFF) {
+                            changedMin = i;
+                        }
+                        changedMax = i;
+                    }
+                }
+
+                if (changedMin != 0xFF) {
+                    mark(page, x0 + changedMin, x0 + changedMax, op != ST7558_ROP_AND);
+                }
+            }
+        }
+
+        /**************************************************************/
+        /** @brief Draw a row-major bitmap as a grid of transposed 8x8
+                   blocks, handing bands of up to ST7558_RASTER_BLOCKS
+                   blocks to blit(x, y, cols, w, h). Blocks outside
+                   the target are skipped before they are read
+            @param  width   target width
+            @param  clipTop first target row held
+            @param  clipBottom  row past the last one held
+        */
+        /**************************************************************/
+        template <class Blit>
+        static void rowMajor(const int16_t x, const int16_t y, const uint8_t *bitmap,
+                             const int16_t w, const int16_t h, const bool progmem,
+                             const uint8_t width, const int16_t clipTop,
+                             const int16_t clipBottom, Blit blit) {
+
+            const int16_t stride = (w + 7) / 8;
+            const int16_t b0 = (x < 0) ? -x / 8 : 0;
+            int16_t b1 = (width - x + 7) / 8;
+            if (b1 > stride) {
+                b1 = stride;
+            }
+            if (b0 >= b1) {
+                return;
+            }
+
+            uint8_t band[ST7558_RASTER_BLOCKS * 8];
+            uint8_t rows[8];
+
+            for (int16_t r = 0; r < h; r += 8) {
+
+                const uint8_t n = (h - r < 8) ? h - r : 8;
+                if (y + r >= clipBottom) {
+                    break;
+                }
+                if (y + r + n <= clipTop) {
+                    continue;
+                }
+                for (int16_t bs = b0; bs < b1; bs += ST7558_RASTER_BLOCKS) {
+
+                    const int16_t be = (b1 - bs < ST7558_RASTER_BLOCKS) ? b1 : bs + ST7558_RASTER_BLOCKS;
+                    for (int16_t b = bs; b < be; b++) {
+
+                        const uint8_t *src = &bitmap[r * stride + b];
+                        for (uint8_t j = 0; j < 8; j++, src += stride) {
+                            rows[j] = (j < n) ? readByte(src, progmem) : 0;
+                        }
+                        transpose8(rows, &band[(b - bs) * 8]);
+                    }
+                    const int16_t cw = (w - bs * 8 < (be - bs) * 8) ? w - bs * 8 : (be - bs) * 8;
+                    blit(x + bs * 8, y + r, band, cw, n);
+                }
+            }
+        }
+
+        /**************************************************************/
+        /** @brief Walk circle quadrants without the axis points, like
+                   Adafruit_GFX::drawCircleHelper(), handing each
+                   pixel to plot(x, y). The midpoint walk can land on
+                   the diagonal, or step past it, and then repeats a
+                   pixel of the other octant; those are skipped
+            @param  corners bit 0 top left, 1 top right, 2 bottom
+                            right, 3 bottom left
+        */
+        /**************************************************************/
+        template <class Plot>
+        static void arc(const int16_t x0, const int16_t y0, const int16_t r,
+                        const uint8_t corners, Plot plot) {
+
+            int16_t f = 1 - r, ddx = 1, ddy = -2 * r, x = 0, y = r;
+            while (x < y) {
+
+                if (f >= 0) {
+                    y--;
+                    ddy += 2;
+                    f += ddy;
+                }
+                x++;
+                ddx += 2;
+                f += ddx;
+                if (x > y) {
+                    break;
+                }
+                const bool octant = x < y;
+                if (corners & 0x1) {
+                    plot(x0-x, y0-y);
+                    if (octant) {
+                        plot(x0-y, y0-x);
+                    }
+                }
+                if (corners & 0x2) {
+                    plot(x0+x, y0-y);
+                    if (octant) {
+                        plot(x0+y, y0-x);
+                    }
+                }
+                if (corners & 0x4) {
+                    plot(x0+x, y0+y);
+                    if (octant) {
+                        plot(x0+y, y0+x);
+                    }
+                }
+                if (corners & 0x8) {
+                    plot(x0-x, y0+y);
+                    if (octant) {
+                        plot(x0-y, y0+x);
+                    }
+                }
+            }
+        }
+
+        /**************************************************************/
+        /** @brief Clamp a corner radius to half the shorter side, as
+                   Adafruit_GFX does
+        */
+        /**************************************************************/
+        static int16_t cornerRadius(const int16_t w, const int16_t h, const int16_t r) {
+
+            const int16_t maxRadius = ((w < h) ? w : h) / 2;
+            return (r > maxRadius) ? maxRadius : r;
+        }
+
+        /**************************************************************/
+        /** @brief Outline a rectangle with fill(x, y, w, h) spans,
+                   each pixel once, so INVERSE doesn't flip the
+                   corners back
+        */
+        /**************************************************************/
+        template <class Fill>
+        static void rect(const int16_t x, const int16_t y, const int16_t w,
+                         const int16_t h, Fill fill) {
+
+            if (w <= 0 || h <= 0) {
+                return;
+            }
+            fill(x, y, w, 1);
+            if (h > 1) {
+                fill(x, y + h - 1, w, 1);
+            }
+            if (h > 2) {
+                fill(x, y + 1, 1, h - 2);
+                if (w > 1) {
+                    fill(x + w - 1, y + 1, 1, h - 2);
+                }
+            }
+        }
+
+        /**************************************************************/
+        /** @brief Outline a rectangle with rounded corners, each
+                   pixel once: the same shape as Adafruit_GFX, without
+                   the pixels it draws twice. At a radius of 1 on a
+                   side of 2 Adafruit_GFX's empty edge lines still
+                   draw two pixels each and fill the corners, so that
+                   is a plain rectangle
+        */
+        /**************************************************************/
+        template <class Fill, class Plot>
+        static void roundRect(const int16_t x, const int16_t y, const int16_t w,
+                              const int16_t h, int16_t r, Fill fill, Plot plot) {
+
+            r = cornerRadius(w, h, r);
+            if (r <= 0 || (r == 1 && (w == 2 || h == 2))) {
+                rect(x, y, w, h, fill);
+                return;
+            }
+            fill(x + r, y, w - 2 * r, 1);
+            fill(x + r, y + h - 1, w - 2 * r, 1);
+            fill(x, y + r, 1, h - 2 * r);
+            fill(x + w - 1, y + r, 1, h - 2 * r);
+            arc(x + r, y + r, r, 1, plot);
+            arc(x + w - r - 1, y + r, r, 2, plot);
+            arc(x + w - r - 1, y + h - r - 1, r, 4, plot);
+            arc(x + r, y + h - r - 1, r, 8, plot);
+        }
+
+        /**************************************************************/
+        /** @brief Check for a filled round rect Adafruit_GFX draws as
+                   a plain rectangle: at a radius of 1 on a height of
+                   2 its empty edge lines fill the corners, which the
+                   fast lines of ST7558 and ST7558Canvas don't draw
+        */
+        /**************************************************************/
+        static bool filledRoundRectIsRect(const int16_t w, const int16_t h, const int16_t r) {
+            return h == 2 && cornerRadius(w, h, r) == 1;
+        }
+
+        /**************************************************************/
+        /** @brief Outline a circle with plot(x, y), each pixel once
+        */
+        /**************************************************************/
+        template <class Plot>
+        static void circle(const int16_t x0, const int16_t y0, const int16_t r, Plot plot) {
+
+            if (r < 0) {
+                return;
+            }
+            plot(x0, y0 - r);
+            if (r == 0) {
+                return;
+            }
+            plot(x0, y0 + r);
+            plot(x0 + r, y0);
+            plot(x0 - r, y0);
+            arc(x0, y0, r, 0x0F, plot);
+        }
+};
+
+#endif
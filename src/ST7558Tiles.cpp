@@ -0,0 +1,298 @@
+/**
+ * @file ST7558Tiles.cpp
+ *
+ * Tile map and sprite layer, see ST7558Tiles.h
+ *
+ * @section License
+ *
+ *  GNU GENERAL PUBLIC LICENSE ver. 3
+ *
+ */
+
+#include "ST7558Tiles.h"
+
+ST7558TileLayer::ST7558TileLayer(ST7558 &lcd) :
+    _lcd(lcd), _tileset(NULL), _tilesProgmem(false) {
+
+    memset(_map, 0, sizeof(_map));
+    memset(_sprites, 0, sizeof(_sprites));
+    invalidate();
+}
+
+/**************************************************************/
+/** @brief Set the tile graphics: 8 page-major bytes per tile,
+           tile n at tiles[8 * n]. Every tile is redrawn
+    @param  tiles   tileset in PROGMEM
+*/
+/**************************************************************/
+void ST7558TileLayer::setTileset(const uint8_t *tiles) {
+
+    _tileset = tiles;
+    _tilesProgmem = true;
+    invalidate();
+}
+
+/**************************************************************/
+/** @brief Same as above, with the tileset in RAM
+*/
+/**************************************************************/
+void ST7558TileLayer::setTileset(uint8_t *tiles) {
+
+    _tileset = tiles;
+    _tilesProgmem = false;
+    invalidate();
+}
+
+/**************************************************************/
+/** @brief Put a tile on the map. Nothing is redrawn if the
+           cell already holds it
+    @param  tx  tile column, 0..ST7558_TILES_X - 1
+    @param  ty  tile row (page), 0..ST7558_TILES_Y - 1
+    @param  tile    index into the tileset
+*/
+/**************************************************************/
+void ST7558TileLayer::setTile(const uint8_t tx, const uint8_t ty, const uint8_t tile) {
+
+    if (tx < ST7558_TILES_X && ty < ST7558_TILES_Y && _map[ty][tx] != tile) {
+
+        _map[ty][tx] = tile;
+        _dirty[ty] |= 1 << tx;
+    }
+}
+
+uint8_t ST7558TileLayer::getTile(const uint8_t tx, const uint8_t ty) {
+
+    return (tx < ST7558_TILES_X && ty < ST7558_TILES_Y) ? _map[ty][tx] : 0;
+}
+
+/**************************************************************/
+/** @brief Put the same tile in every cell of the map
+*/
+/**************************************************************/
+void ST7558TileLayer::fillTiles(const uint8_t tile) {
+
+    for (uint8_t ty = 0; ty < ST7558_TILES_Y; ty++) {
+        for (uint8_t tx = 0; tx < ST7558_TILES_X; tx++) {
+            setTile(tx, ty, tile);
+        }
+    }
+}
+
+/**************************************************************/
+/** @brief Show a sprite, or change one. Sprites are drawn in id
+           order, a higher id on top
+    @param  id  0..ST7558_MAX_SPRITES - 1
+    @param  x   left column, may be off screen
+    @param  y   top row, may be off screen
+    @param  bitmap  page-major sprite in PROGMEM
+    @param  w   sprite width
+    @param  h   sprite height
+    @param  mask    page-major mask in PROGMEM: pixels with a set
+                    mask bit are copied, the others show what is
+                    below. NULL - only set pixels are drawn
+*/
+/**************************************************************/
+void ST7558TileLayer::setSprite(const uint8_t id, const int16_t x, const int16_t y,
+                                const uint8_t *bitmap, const uint8_t w, const uint8_t h,
+                                const uint8_t *mask) {
+    _setSprite(id, x, y, bitmap, w, h, mask, true);
+}
+
+/**************************************************************/
+/** @brief Same as above, with the sprite and mask in RAM
+*/
+/**************************************************************/
+void ST7558TileLayer::setSprite(const uint8_t id, const int16_t x, const int16_t y,
+                                uint8_t *bitmap, const uint8_t w, const uint8_t h,
+                                uint8_t *mask) {
+    _setSprite(id, x, y, bitmap, w, h, mask, false);
+}
+
+void ST7558TileLayer::_setSprite(const uint8_t id, const int16_t x, const int16_t y,
+                                 const uint8_t *bitmap, const uint8_t w, const uint8_t h,
+                                 const uint8_t *mask, const bool progmem) {
+
+    if (id >= ST7558_MAX_SPRITES) {
+        return;
+    }
+    Sprite &sprite = _sprites[id];
+    _markSprite(sprite);
+    sprite.x = x;
+    sprite.y = y;
+    sprite.w = w;
+    sprite.h = h;
+    sprite.bitmap = bitmap;
+    sprite.mask = mask;
+    sprite.progmem = progmem;
+    sprite.visible = bitmap != NULL;
+    _markSprite(sprite);
+}
+
+/**************************************************************/
+/** @brief Move a sprite. Only the tiles it leaves and enters are
+           redrawn
+*/
+/**************************************************************/
+void ST7558TileLayer::moveSprite(const uint8_t id, const int16_t x, const int16_t y) {
+
+    if (id >= ST7558_MAX_SPRITES) {
+        return;
+    }
+    Sprite &sprite = _sprites[id];
+    if (sprite.x == x && sprite.y == y) {
+        return;
+    }
+    _markSprite(sprite);
+    sprite.x = x;
+    sprite.y = y;
+    _markSprite(sprite);
+}
+
+void ST7558TileLayer::hideSprite(const uint8_t id) {
+
+    if (id < ST7558_MAX_SPRITES && _sprites[id].visible) {
+
+        _markSprite(_sprites[id]);
+        _sprites[id].visible = false;
+    }
+}
+
+/**************************************************************/
+/** @brief Redraw every tile with the next render(), e.g. after
+           drawing over the layer with the GFX functions
+*/
+/**************************************************************/
+void ST7558TileLayer::invalidate(void) {
+
+    for (uint8_t ty = 0; ty < ST7558_TILES_Y; ty++) {
+        _dirty[ty] = (1 << ST7558_TILES_X) - 1;
+    }
+}
+
+/**************************************************************/
+/** @brief Compose the changed tiles with the sprites over them
+           and write them to the framebuffer. Call display()
+           after it. In strip mode the strip is drawn every pass
+           from the whole map, call it inside the page loop
+    @return number of tiles written
+*/
+/**************************************************************/
+uint8_t ST7558TileLayer::render(void) {
+
+    uint8_t tile[8];
+    uint8_t drawn = 0;
+
+    for (uint8_t ty = 0; ty < ST7558_TILES_Y; ty++) {
+
+    #ifdef ST7558_STRIP_PAGES
+        const uint16_t dirty = (1 << ST7558_TILES_X) - 1;
+    #else
+        const uint16_t dirty = _dirty[ty];
+        _dirty[ty] = 0;
+    #endif
+        for (uint8_t tx = 0; tx < ST7558_TILES_X; tx++) {
+
+            if (dirty & (1 << tx)) {
+
+                _compose(tx, ty, tile);
+                _lcd.blit(tx * 8, ty * 8, tile, 8, 8, ST7558_ROP_COPY);
+                drawn++;
+            }
+        }
+    }
+    return drawn;
+}
+
+/**************************************************************/
+/** @brief This method marks the tiles a rectangle touches
+*/
+/**************************************************************/
+void ST7558TileLayer::_markRect(int16_t x, int16_t y, int16_t w, int16_t h) {
+
+    if (x < 0) {
+        w += x;
+        x = 0;
+    }
+    if (y < 0) {
+        h += y;
+        y = 0;
+    }
+    if (w <= 0 || h <= 0 || x >= ST7558_TILES_X * 8 || y >= ST7558_TILES_Y * 8) {
+        return;
+    }
+    const uint8_t tx1 = (x + w - 1 < ST7558_TILES_X * 8) ? (x + w - 1) / 8 : ST7558_TILES_X - 1;
+    const uint8_t ty1 = (y + h - 1 < ST7558_TILES_Y * 8) ? (y + h - 1) / 8 : ST7558_TILES_Y - 1;
+    const uint16_t bits = ((2 << tx1) - 1) & ~((1 << (x / 8)) - 1);
+    for (uint8_t ty = y / 8; ty <= ty1; ty++) {
+        _dirty[ty] |= bits;
+    }
+}
+
+void ST7558TileLayer::_markSprite(const Sprite &sprite) {
+
+    if (sprite.visible) {
+        _markRect(sprite.x, sprite.y, sprite.w, sprite.h);
+    }
+}
+
+/**************************************************************/
+/** @brief This method builds one tile's 8 column bytes: the map
+           tile, then every visible sprite over it, shifted to
+           the tile's rows
+*/
+/**************************************************************/
+void ST7558TileLayer::_compose(const uint8_t tx, const uint8_t ty, uint8_t *out) {
+
+    if (_tileset) {
+
+        const uint8_t *src = &_tileset[_map[ty][tx] * 8];
+        for (uint8_t c = 0; c < 8; c++) {
+            out[c] = ST7558Raster::readByte(&src[c], _tilesProgmem);
+        }
+    } else {
+        memset(out, 0, 8);
+    }
+
+    const int16_t left = tx * 8, top = ty * 8;
+    for (uint8_t id = 0; id < ST7558_MAX_SPRITES; id++) {
+
+        const Sprite &sprite = _sprites[id];
+        if (!sprite.visible || sprite.x >= left + 8 || sprite.x + sprite.w <= left ||
+            sprite.y >= top + 8 || sprite.y + sprite.h <= top) {
+            continue;
+        }
+
+        // the tile's rows start 'off' rows into the sprite
+        const int16_t off = top - sprite.y;
+        const uint8_t pages = (sprite.h + 7) / 8;
+        const uint8_t tail = 0xFF >> ((8 - sprite.h % 8) % 8);
+        const int16_t p = (off >= 0) ? off / 8 : -1;
+        const uint8_t shift = (off >= 0) ? off % 8 : 8 + off;
+        const int16_t c0 = (sprite.x > left) ? sprite.x - left : 0;
+        const int16_t c1 = (sprite.x + sprite.w < left + 8) ? sprite.x + sprite.w - left : 8;
+
+        for (int16_t c = c0; c < c1; c++) {
+
+            const uint8_t column = left + c - sprite.x;
+            uint8_t bits = 0, mask = 0;
+            for (int16_t k = p; k <= p + 1; k++) {
+
+                if (k < 0 || k >= pages) {
+                    continue;
+                }
+                const uint8_t keep = (k == pages - 1) ? tail : 0xFF;
+                const uint16_t i = k * sprite.w + column;
+                const uint8_t b = ST7558Raster::readByte(&sprite.bitmap[i], sprite.progmem) & keep;
+                const uint8_t m = sprite.mask ? ST7558Raster::readByte(&sprite.mask[i], sprite.progmem) & keep : 0;
+                if (k == p) {
+                    bits |= b >> shift;
+                    mask |= m >> shift;
+                } else if (shift) {
+                    bits |= b << (8 - shift);
+                    mask |= m << (8 - shift);
+                }
+            }
+            out[c] = sprite.mask ? (out[c] & ~mask) | (bits & mask) : out[c] | bits;
+        }
+    }
+}
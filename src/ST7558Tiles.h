@@ -0,0 +1,82 @@
+/**
+ * @file ST7558Tiles.h
+ *
+ * Tile map and sprite layer for game-style screens on the ST7558 driver.
+ * The top 96x64 pixels are a grid of page-aligned 8x8 tiles (12x8 on the
+ * C115 panel), with a few sprites composited on top. Each tile keeps a
+ * dirty bit: render() recomposes only the tiles whose map entry changed
+ * or that a sprite entered or left, so only those columns reach the
+ * framebuffer and the bus.
+ *
+ * Tiles and sprites are page-major, the format of ST7558::blit(): a tile
+ * is 8 column bytes, LSB on top. Convert GFX bitmaps with
+ * ST7558::toPageMajor(). As for blit(), const data is read from PROGMEM
+ * and non-const data from RAM.
+ *
+ * @section License
+ *
+ *  GNU GENERAL PUBLIC LICENSE ver. 3
+ *
+ */
+
+#ifndef ST7558_TILES_H
+#define ST7558_TILES_H
+
+#include "ST7558.h"
+
+#define ST7558_TILES_X      (ST7558_WIDTH / 8)
+#define ST7558_TILES_Y      (ST7558_HEIGHT / 8)
+
+#ifndef ST7558_MAX_SPRITES
+    #define ST7558_MAX_SPRITES  8
+#endif
+
+class ST7558TileLayer {
+
+    private:
+
+        struct Sprite {
+
+            int16_t x, y;
+            uint8_t w, h;
+            const uint8_t *bitmap;          // page-major, w * ((h + 7) / 8) bytes
+            const uint8_t *mask;            // same format, NULL - set bits are drawn
+            bool progmem;
+            bool visible;
+        };
+
+        ST7558 &_lcd;
+        const uint8_t *_tileset;
+        bool _tilesProgmem;
+        uint8_t _map[ST7558_TILES_Y][ST7558_TILES_X];
+        uint16_t _dirty[ST7558_TILES_Y];    // one bit per tile column
+        Sprite _sprites[ST7558_MAX_SPRITES];
+
+        void _markRect(int16_t x, int16_t y, int16_t w, int16_t h);
+        void _markSprite(const Sprite &sprite);
+        void _setSprite(uint8_t id, int16_t x, int16_t y, const uint8_t *bitmap,
+                        uint8_t w, uint8_t h, const uint8_t *mask, bool progmem);
+        void _compose(uint8_t tx, uint8_t ty, uint8_t *out);
+
+    public:
+
+        ST7558TileLayer(ST7558 &lcd);
+
+        void setTileset(const uint8_t *tiles);
+        void setTileset(uint8_t *tiles);
+        void setTile(uint8_t tx, uint8_t ty, uint8_t tile);
+        uint8_t getTile(uint8_t tx, uint8_t ty);
+        void fillTiles(uint8_t tile);
+
+        void setSprite(uint8_t id, int16_t x, int16_t y, const uint8_t *bitmap,
+                       uint8_t w, uint8_t h, const uint8_t *mask = NULL);
+        void setSprite(uint8_t id, int16_t x, int16_t y, uint8_t *bitmap,
+                       uint8_t w, uint8_t h, uint8_t *mask = NULL);
+        void moveSprite(uint8_t id, int16_t x, int16_t y);
+        void hideSprite(uint8_t id);
+
+        void invalidate(void);
+        uint8_t render(void);
+};
+
+#endif
@@ -0,0 +1,156 @@
+/**
+ * @file ST7558Transport.cpp
+ *
+ * Out-of-line parts of the ST7558 bus backends (Linux i2c-dev only, the
+ * other backends are header-only).
+ *
+ * @section License
+ *
+ *  GNU GENERAL PUBLIC LICENSE ver. 3
+ *
+ */
+
+#include "ST7558Transport.h"
+
+#if defined(__linux__)
+
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <linux/i2c.h>
+#include <linux/i2c-dev.h>
+
+ST7558LinuxI2CTransport::ST7558LinuxI2CTransport(const char *path) :
+    _path(path), _fd(-1), _file(false), _batching(false), _address(0),
+    _count(0), _used(0), _start(0), _syscalls(0), _errors(0) {}
+
+/**************************************************************/
+/** @brief A copy takes the path only and opens its own
+           descriptor in begin(), so ST7558(rst, bus) can be given
+           a bus that is already open without two owners closing
+           one descriptor
+*/
+/**************************************************************/
+ST7558LinuxI2CTransport::ST7558LinuxI2CTransport(const ST7558LinuxI2CTransport &other) :
+    ST7558LinuxI2CTransport(other._path) {}
+
+ST7558LinuxI2CTransport &ST7558LinuxI2CTransport::operator=(const ST7558LinuxI2CTransport &other) {
+
+    if (this != &other) {
+
+        if (_fd >= 0) {
+            close(_fd);
+        }
+        _path = other._path;
+        _fd = -1;
+        _file = _batching = false;
+        _count = 0;
+        _used = _start = 0;
+        _syscalls = _errors = 0;
+    }
+    return *this;
+}
+
+ST7558LinuxI2CTransport::~ST7558LinuxI2CTransport() {
+
+    if (_fd >= 0) {
+        close(_fd);
+    }
+}
+
+/**************************************************************/
+/** @brief Open the adapter. The bus clock of an i2c-dev adapter
+           is set by the kernel (device tree), not from userspace,
+           so the clock argument is ignored
+*/
+/**************************************************************/
+void ST7558LinuxI2CTransport::begin(uint32_t) {
+
+    struct stat st;
+
+    if (_fd >= 0) {
+        return;
+    }
+    _fd = open(_path, O_RDWR);
+    if (_fd >= 0 && fstat(_fd, &st) == 0 && S_ISREG(st.st_mode)) {
+        _file = true;
+        lseek(_fd, 0, SEEK_END);
+    }
+}
+
+/**************************************************************/
+/** @brief Check that a device answers, with a zero-length write 
+           (SMBus quick command, as i2cdetect -q does). The file 
+           stand-in always answers
+*/
+/**************************************************************/
+bool ST7558LinuxI2CTransport::probe(uint8_t address) {
+
+    if (_fd < 0) {
+        return false;
+    }
+    if (_file) {
+        return true;
+    }
+
+    struct i2c_msg msg = { address, 0, 0, NULL };
+    struct i2c_rdwr_ioctl_data batch = { &msg, 1 };
+    _syscalls++;
+    return ioctl(_fd, I2C_RDWR, &batch) >= 0;
+}
+
+/**************************************************************/
+/** @brief Send every queued message: one ioctl(I2C_RDWR) for an
+           adapter, one write() for the file stand-in. A batch that
+           fails is counted in errors()
+*/
+/**************************************************************/
+void ST7558LinuxI2CTransport::_flush(void) {
+
+    if (!_count) {
+        return;
+    }
+    if (_fd >= 0) {
+
+        if (_file) {
+
+            uint8_t framed[ST7558_LINUX_BATCH + 3 * ST7558_LINUX_MAX_MSGS];
+            uint16_t n = 0, offset = 0;
+            for (uint8_t i = 0; i < _count; i++) {
+                framed[n++] = _addresses[i];
+                framed[n++] = _lengths[i] & 0xFF;
+                framed[n++] = _lengths[i] >> 8;
+                memcpy(&framed[n], &_data[offset], _lengths[i]);
+                n += _lengths[i];
+                offset += _lengths[i];
+            }
+            if (::write(_fd, framed, n) != n) {
+                close(_fd);                 // stop on a broken file
+                _fd = -1;
+                _errors++;
+            }
+        } else {
+
+            struct i2c_msg msgs[ST7558_LINUX_MAX_MSGS];
+            struct i2c_rdwr_ioctl_data batch = { msgs, _count };
+            uint16_t offset = 0;
+            for (uint8_t i = 0; i < _count; i++) {
+                msgs[i].addr = _addresses[i];
+                msgs[i].flags = 0;
+                msgs[i].len = _lengths[i];
+                msgs[i].buf = &_data[offset];
+                offset += _lengths[i];
+            }
+            if (ioctl(_fd, I2C_RDWR, &batch) < 0) {
+                _errors++;                  // NACK or adapter error, the batch is lost
+            }
+        }
+        _syscalls++;
+    }
+    _count = 0;
+    _used = 0;
+}
+
+#endif
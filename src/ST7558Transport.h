@@ -0,0 +1,274 @@
+/**
+ * @file ST7558Transport.h
+ *
+ * Bus backends for the ST7558 driver. The driver talks to its bus through
+ * a compile-time policy (ST7558_TRANSPORT), so every call below is inlined
+ * into _i2cwrite() and there is no virtual dispatch on the hot path.
+ *
+ * A backend provides:
+ *
+ *      void begin(uint32_t clock);
+ *      void setClock(uint32_t clock);
+ *      bool probe(uint8_t address);                 // true if the address ACKs
+ *      void beginTransmission(uint8_t address);     // START + address
+ *      void write(uint8_t data);
+ *      void endTransmission(void);                  // STOP
+ *      void beginFrame(void);                       // a display() starts
+ *      void endFrame(void);                         // a display() is done
+ *      uint8_t bufferSize(void) const;              // bytes per transaction after the address
+ *
+ * Backends:
+ *
+ *      ST7558WireTransport       any Arduino TwoWire instance (default)
+ *      ST7558LinuxI2CTransport   Linux /dev/i2c-N, one ioctl(I2C_RDWR) per frame
+ *      ST7558RecordingTransport  in-memory log of every transaction
+ *
+ * Pick one with a build flag, e.g. -DST7558_TRANSPORT=ST7558LinuxI2CTransport
+ *
+ * @section License
+ *
+ *  GNU GENERAL PUBLIC LICENSE ver. 3
+ *
+ */
+
+#ifndef ST7558_TRANSPORT_H
+#define ST7558_TRANSPORT_H
+
+#if defined(ARDUINO) && ARDUINO >= 100
+    #include "Arduino.h"
+#else
+    #include "WProgram.h"
+#endif
+#include <Wire.h>
+
+// Wire's transmit buffer on this core, the longest transaction the driver 
+// may send. Override with -DST7558_WIRE_BUFFER=n for other cores
+#ifndef ST7558_WIRE_BUFFER
+    #if defined(I2C_BUFFER_LENGTH)              // ESP32, ESP8266: 128
+        #define ST7558_WIRE_BUFFER  I2C_BUFFER_LENGTH
+    #elif defined(WIRE_BUFFER_SIZE)             // RP2040 (arduino-pico): 256
+        #define ST7558_WIRE_BUFFER  WIRE_BUFFER_SIZE
+    #elif defined(ARDUINO_ARCH_SAMD) || defined(ARDUINO_ARCH_MBED)
+        #define ST7558_WIRE_BUFFER  256
+    #elif defined(BUFFER_LENGTH)                // AVR: 32, Teensy 4: 136
+        #define ST7558_WIRE_BUFFER  BUFFER_LENGTH
+    #else
+        #define ST7558_WIRE_BUFFER  32
+    #endif
+#endif
+
+// Smallest transaction the driver can work with: the control byte, a full
+// command queue (ST7558_CMD_QUEUE) of control/command pairs and one data
+// byte. Smaller buffer sizes are raised to it
+#define ST7558_MIN_BUFFER   18
+
+/**************************************************************/
+/** @brief Arduino TwoWire backend. Works with any bus instance,
+           not only the global Wire. bufferSize is the core's Wire 
+           transmit buffer, detected at compile time by default, 
+           and kept within ST7558_MIN_BUFFER..255
+*/
+/**************************************************************/
+class ST7558WireTransport {
+
+    private:
+
+        TwoWire *_wire;
+        uint8_t _bufferSize;
+
+    public:
+
+        ST7558WireTransport(TwoWire &wire = Wire, 
+                            uint16_t bufferSize = ST7558_WIRE_BUFFER) : 
+            _wire(&wire), _bufferSize(bufferSize > 255 ? 255 : 
+                                      bufferSize < ST7558_MIN_BUFFER ? ST7558_MIN_BUFFER : 
+                                      bufferSize) {}
+
+        void begin(uint32_t clock) {
+
+            _wire->begin();
+            _wire->setClock(clock);
+        }
+        void setClock(uint32_t clock) { _wire->setClock(clock); }
+        bool probe(uint8_t address) {
+
+            _wire->beginTransmission(address);
+            return _wire->endTransmission() == 0;
+        }
+        void beginTransmission(uint8_t address) { _wire->beginTransmission(address); }
+        void write(uint8_t data) { _wire->write(data); }
+        void endTransmission(void) { _wire->endTransmission(); }
+        void beginFrame(void) {}
+        void endFrame(void) {}
+        uint8_t bufferSize(void) const { return _bufferSize; }
+};
+
+/**************************************************************/
+/** @brief In-memory backend. Each transaction is stored in the
+           caller's buffer as a little-endian 16-bit length
+           followed by the bytes sent after the address. When the
+           buffer is full further transactions are only counted
+*/
+/**************************************************************/
+class ST7558RecordingTransport {
+
+    private:
+
+        uint8_t *_log;
+        uint16_t _capacity;
+        uint16_t _size;
+        uint16_t _open;                     // offset of the open transaction's length
+        uint16_t _transactions;
+        bool _overflow;
+
+    public:
+
+        ST7558RecordingTransport(uint8_t *log = NULL, uint16_t capacity = 0) :
+            _log(log), _capacity(capacity), _size(0), _open(0),
+            _transactions(0), _overflow(false) {}
+
+        void begin(uint32_t) {}
+        void setClock(uint32_t) {}
+        bool probe(uint8_t) { return true; }
+        void beginTransmission(uint8_t) {
+
+            _transactions++;
+            if (_size + 2 > _capacity) {
+                _overflow = true;
+                return;
+            }
+            _open = _size;
+            _log[_size++] = 0;
+            _log[_size++] = 0;
+        }
+        void write(uint8_t data) {
+
+            if (_overflow || _size >= _capacity) {
+                _overflow = true;
+                return;
+            }
+            _log[_size++] = data;
+        }
+        void endTransmission(void) {
+
+            if (!_overflow) {
+                const uint16_t n = _size - _open - 2;
+                _log[_open] = n & 0xFF;
+                _log[_open + 1] = n >> 8;
+            }
+        }
+        void beginFrame(void) {}
+        void endFrame(void) {}
+        uint8_t bufferSize(void) const { return 255; }
+
+        void clear(void) {
+
+            _size = 0;
+            _transactions = 0;
+            _overflow = false;
+        }
+        const uint8_t *data(void) const { return _log; }
+        uint16_t size(void) const { return _size; }
+        uint16_t transactions(void) const { return _transactions; }
+        bool overflow(void) const { return _overflow; }
+};
+
+#if defined(__linux__)
+
+#define ST7558_LINUX_MAX_MSGS   42          // I2C_RDWR_IOCTL_MAX_MSGS
+#define ST7558_LINUX_BATCH      2048        // bytes queued before a forced ioctl
+
+/**************************************************************/
+/** @brief Linux userspace backend on /dev/i2c-N. Between
+           beginFrame() and endFrame() transactions are queued
+           and sent with a single ioctl(I2C_RDWR), so a whole
+           display() costs one or two syscalls instead of one
+           per chunk. Messages of one ioctl are joined by repeated
+           STARTs, which the ST7558 treats as new transactions.
+
+           If the path is a regular file (no I2C adapter behind
+           it) every transaction is appended to the file as
+           [address][length lo][length hi][bytes...], which
+           allows testing without hardware.
+*/
+/**************************************************************/
+class ST7558LinuxI2CTransport {
+
+    private:
+
+        const char *_path;
+        int _fd;
+        bool _file;                         // regular file stand-in
+        bool _batching;
+        uint8_t _address;
+        uint8_t _count;                     // queued messages
+        uint16_t _lengths[ST7558_LINUX_MAX_MSGS];
+        uint8_t _addresses[ST7558_LINUX_MAX_MSGS];
+        uint16_t _used;                     // queued bytes
+        uint16_t _start;                    // first byte of the open message
+        uint8_t _data[ST7558_LINUX_BATCH];
+        uint32_t _syscalls;
+        uint32_t _errors;                   // batches the adapter or the file refused
+
+        void _flush(void);
+
+    public:
+
+        ST7558LinuxI2CTransport(const char *path = "/dev/i2c-1");
+        ST7558LinuxI2CTransport(const ST7558LinuxI2CTransport &other);
+        ST7558LinuxI2CTransport &operator=(const ST7558LinuxI2CTransport &other);
+        ~ST7558LinuxI2CTransport();
+
+        void begin(uint32_t clock);
+        void setClock(uint32_t) {}
+        bool probe(uint8_t address);
+        void beginTransmission(uint8_t address) {
+
+            if (_count >= ST7558_LINUX_MAX_MSGS) {
+                _flush();
+            }
+            _address = address;
+            _start = _used;
+        }
+        void write(uint8_t data) {
+
+            if (_used >= ST7558_LINUX_BATCH) {
+
+                // batch full: send the finished messages and move the 
+                // open one to the front of the buffer
+                const uint16_t open = _used - _start;
+                const uint16_t from = _start;
+                if (open >= ST7558_LINUX_BATCH) {
+                    return;
+                }
+                _flush();
+                memmove(_data, &_data[from], open);
+                _start = 0;
+                _used = open;
+            }
+            _data[_used++] = data;
+        }
+        void endTransmission(void) {
+
+            _lengths[_count] = _used - _start;
+            _addresses[_count] = _address;
+            _count++;
+            if (!_batching) {
+                _flush();
+            }
+        }
+        void beginFrame(void) { _batching = true; }
+        void endFrame(void) {
+
+            _batching = false;
+            _flush();
+        }
+        uint8_t bufferSize(void) const { return 255; }
+
+        bool isOpen(void) const { return _fd >= 0; }
+        uint32_t syscalls(void) const { return _syscalls; }
+        uint32_t errors(void) const { return _errors; }
+};
+
+#endif
+#endif